@@ -1,4 +1,5 @@
 #include <parser.hpp>
+#include <arena.hpp>
 
 /// \brief Root rule action: complete datablock parsed.
 /// \details Currently a no-op; hook for top-level file handling/logging.
@@ -16,7 +17,7 @@ template<>
 struct action<udt_header_quoted_name> {
     template<typename Input>
     static void apply(const Input& in, ParserState& st) {
-        st.element_in_scope.push_back(std::make_shared<UDT_RAW>(in.string()));
+        st.element_in_scope.push_back(arena::make<UDT_RAW>(in.string()));
         //std::cout << "UDT QUOTED NAME: "<< in.string()<<"\n";
     }
 };       
@@ -45,7 +46,7 @@ struct action<udt_raw_basic_type> {
         
         st.type = in.string();
         if(st.type.find("Struct") != std::string::npos) {
-            std::shared_ptr<STRUCT_SINGLE> el = std::make_shared<STRUCT_SINGLE>(st.name,"Struct");
+            std::shared_ptr<STRUCT_SINGLE> el = arena::make<STRUCT_SINGLE>(st.name,"Struct");
         std::shared_ptr<BASE_CONTAINER> par;
         std::visit([&](auto&& el)
         {
@@ -145,7 +146,7 @@ struct action<db_header_declaration> {
     template<typename Input>
     static void apply(const Input& in, ParserState& st) {
         //std::cout << "DB HEADER DECLARATION: "<< in.string()<<"\n";
-        st.db = std::make_shared<DB>(st.DB_name);
+        st.db = arena::make<DB>(st.DB_name);
         st.element_in_scope.push_back(st.db);
     }
 };
@@ -202,7 +203,7 @@ struct action<db_body_type> {
         //std::cout << "DB BODY TYPE: "<< in.string()<<"\n";
         st.type = in.string();
         if(st.type.find("Struct") != std::string::npos) {
-            st.element_in_scope.push_back(std::make_shared<STRUCT_SINGLE>(st.name,"Struct"));
+            st.element_in_scope.push_back(arena::make<STRUCT_SINGLE>(st.name,"Struct"));
         }
     }
 };
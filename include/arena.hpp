@@ -0,0 +1,121 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <cstddef>
+#include <string_pool.hpp>
+
+/**
+ * @brief Per-DB arena for the element tree.
+ * @details
+ * Every node of a DB (leaves, containers, UDT definitions of its file) is created with
+ * arena::make while an arena::Scope is active on the building thread. Nodes and their
+ * shared_ptr control blocks are then carved out of one monotonic buffer instead of one
+ * heap allocation each. Parents are plain pointers, so the tree has no ownership cycles:
+ * when the last handle to the DB goes, the nodes are destroyed and the arena chunks are
+ * released together.
+ *
+ * The allocator stored in each control block keeps the arena alive, so a node that
+ * outlives its DB (e.g. still held by a view) stays valid. A weak_ptr to a node keeps its
+ * control block, hence the whole arena, until it is reset.
+ *
+ * An arena is used by one thread at a time: the parser thread while the DB is built, then
+ * the GUI thread (UDT array elements materialized on demand).
+ *
+ * On the project DBs the gain is at release time, not at build time: the trees stay
+ * small until UDT array elements are opened, and the first 64 KiB chunk costs more than
+ * it saves. The chunks grow geometrically, so a fully opened DB can reserve about 1.6x
+ * the bytes it hands out.
+ *
+ * Names, types and comments of the nodes are interned in the StringPool of the arena,
+ * normally the pool of the project (see DbCatalog). The arena holds a reference to it, so
+ * the strings live as long as any node built in the arena.
+ */
+class ElementArena
+{
+    private:
+        std::pmr::monotonic_buffer_resource resource{64 * 1024};
+        std::size_t used = 0;
+        std::size_t count = 0;
+        std::shared_ptr<StringPool> strings;
+
+    public:
+        /// \brief Arena interning its strings in \p pool, or in a pool of its own if null.
+        explicit ElementArena(std::shared_ptr<StringPool> pool = nullptr) :
+            strings(pool != nullptr ? std::move(pool) : std::make_shared<StringPool>()) {}
+        ElementArena(const ElementArena&) = delete;
+        ElementArena& operator=(const ElementArena&) = delete;
+
+        void* allocate(std::size_t bytes,std::size_t align)
+        {
+            used += bytes;
+            ++count;
+            return resource.allocate(bytes, align);
+        }
+
+        /// \brief Bytes handed out (nodes and control blocks).
+        std::size_t get_used() const { return used; }
+
+        /// \brief Number of allocations served.
+        std::size_t get_count() const { return count; }
+
+        /// \brief Pool the names of the nodes are interned in.
+        StringPool& get_strings() const { return *strings; }
+};
+
+/// \brief Allocator over an ElementArena; deallocation is a no-op, the arena frees everything
+/// at once.
+template<typename T>
+struct ArenaAllocator
+{
+    using value_type = T;
+
+    std::shared_ptr<ElementArena> arena;
+
+    explicit ArenaAllocator(std::shared_ptr<ElementArena> a) : arena(std::move(a)) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, std::size_t) {}
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+namespace arena
+{
+    /// \brief Arena used by make() on this thread, nullptr for the plain heap.
+    inline thread_local std::shared_ptr<ElementArena> current_arena;
+
+    inline const std::shared_ptr<ElementArena>& current() { return current_arena; }
+
+    /// \brief Makes \p a the arena of this thread until the end of the scope.
+    class Scope
+    {
+        private:
+            std::shared_ptr<ElementArena> previous;
+
+        public:
+            explicit Scope(std::shared_ptr<ElementArena> a) : previous(std::move(current_arena))
+            {
+                current_arena = std::move(a);
+            }
+            ~Scope() { current_arena = std::move(previous); }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+    };
+
+    /// \brief make_shared in the current arena (or on the heap if there is none).
+    template<typename T,typename... Args>
+    std::shared_ptr<T> make(Args&&... args)
+    {
+        if (current_arena != nullptr)
+            return std::allocate_shared<T>(ArenaAllocator<T>(current_arena), std::forward<Args>(args)...);
+        return std::make_shared<T>(std::forward<Args>(args)...);
+    }
+};
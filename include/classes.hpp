@@ -1,6 +1,8 @@
 #pragma once
 
 #include <datatype.hpp>
+#include <arena.hpp>
+#include <string_pool.hpp>
 
 
 namespace class_utils
@@ -15,6 +17,16 @@ namespace class_utils
     void check_offset(std::pair<int,int>& offset_in,std::pair<int,int>& size);
 
     std::pair<int,int> get_size(std::string type);
+
+    std::pair<int,int> get_size(TiaType type);
+
+    void collect_leaves(const VariantElement& el,std::vector<BASE*>& out);
+
+    unsigned long tree_generation();
+
+    void bump_tree_generation();
+
+    unsigned long vis_generation();
 }
 
 namespace translate{    
@@ -27,6 +39,8 @@ namespace translate{
 
     Value generic_get(const std::vector<unsigned char>& buffer, std::pair<int,int>offset_in, const std::string& type_in);
 
+    Value decode(const LeafRecord& rec,const std::vector<unsigned char>& buffer);
+
     bool parse_bool(std::string& bool_in);
 
     Value parse_type(std::string& input);
@@ -36,12 +50,13 @@ namespace translate{
 class Element{
     protected:
         bool is_vis = true;
-        std::shared_ptr<BASE_CONTAINER> parent;
+        BASE_CONTAINER* parent = nullptr;       ///< Non-owning, the parent owns its children.
     public:
-        void set_parent(std::shared_ptr<BASE_CONTAINER> in );
+        void set_parent(const std::shared_ptr<BASE_CONTAINER>& in );
+        void set_parent(BASE_CONTAINER* in );
         virtual void set_vis(bool in) = 0;
 
-        std::shared_ptr<BASE_CONTAINER> get_parent()const;
+        BASE_CONTAINER* get_parent()const;
         virtual bool get_vis() =0;
 };
 
@@ -49,35 +64,46 @@ class Element{
 class BASE : public Element
 {
     protected:
-    std::string name;
-    std::string type; 
-    std::string comment = "xyz";
+    PooledString name;
+    PooledString type;
+    TiaType type_code = TiaType::Unknown;
+    PooledString comment = no_comment();
     std::pair<int, int> offset; 
+    std::pair<int, int> size;
     Value data = "-";
+    int leaf_id = -1;
+
+    static const PooledString& no_comment();
     
     public:
     BASE() = default;
     BASE(std::string name_in, std::string type_in);
     
-    std::string get_name() const;
-    std::string get_type() const;
-    std::string get_comment() const;
+    const std::string& get_name() const;
+    const std::string& get_type() const;
+    TiaType get_type_code() const;
+    const std::string& get_comment() const;
     std::pair<int,int> get_offset() const;
+    std::pair<int,int> get_size() const;
     Value get_data()const;
+    int get_leaf_id()const;
     bool get_vis() override;
 
     void set_name(std::string name_in);
     void set_type(std::string type_in);
     void set_data(const std::vector<unsigned char>& buffer);
+    void set_value(Value value_in);
+    void set_leaf_id(int id_in);
     void set_vis(bool b_in) override;
     void set_offset(std::pair<int,int>& offset_in);
+    void set_layout(std::pair<int,int> offset_in);
 };
 
 class BASE_CONTAINER : public Element{
     protected:
     bool is_vis_set = false;
-    std::string name;
-    std::string type;
+    PooledString name;
+    PooledString type;
     std::vector<VariantElement> childs;
     std::vector<std::pair<std::string,VariantElement>> names;
 
@@ -85,10 +111,10 @@ class BASE_CONTAINER : public Element{
     BASE_CONTAINER() = default;
     BASE_CONTAINER(std::string name_in,std::string type_in);
     
-    std::string get_name()const;
-    std::string get_type()const;
-    std::vector<VariantElement> get_childs()const;
-    std::vector<std::pair<std::string,VariantElement>> get_names()const;
+    const std::string& get_name()const;
+    const std::string& get_type()const;
+    const std::vector<VariantElement>& get_childs()const;
+    const std::vector<std::pair<std::string,VariantElement>>& get_names()const;
     bool get_vis() override;
 
     void set_name(std::string name_in);
@@ -105,14 +131,14 @@ class BASE_CONTAINER : public Element{
 
 class UDT_RAW {
     protected:
-    std::string raw_name;
+    PooledString raw_name;
     std::vector<VariantElement> childs;
 
     public:
     UDT_RAW() = default;
     UDT_RAW(std::string name);
 
-    std::string get_name()const;
+    const std::string& get_name()const;
     const std::vector<VariantElement>& get_childs() const;
 
     void insert_child(VariantElement el_to_add);
@@ -184,6 +210,8 @@ class UDT_ARR_ELEM : public UDT_SINGLE {
     public:
     int get_index()const{return index; }
     int get_max_index()const{return max_index;}
+    void set_index(int index_in){index = index_in;}
+    void set_max_index(int max_in){max_index = max_in;}
     UDT_ARR_ELEM()=default;
     UDT_ARR_ELEM(std::shared_ptr<UDT_ARR_ELEM> el,std::shared_ptr<BASE_CONTAINER> par);
 
@@ -191,19 +219,51 @@ class UDT_ARR_ELEM : public UDT_SINGLE {
         (std::shared_ptr<UDT_SINGLE> el,int arr_nr,int max_arr_nr,std::shared_ptr<BASE_CONTAINER> parent);
 };
 
+/// \brief Array of a UDT, stored as one element layout plus a stride.
+/// \details The prototype is a single element laid out from offset {0,0}; element i starts
+/// at base + (i - start) * stride. UDT_ARR_ELEM nodes are built only when asked for
+/// (get_element), so building and laying out the array costs O(UDT size), not
+/// O(UDT size x length). get_childs() returns the materialized elements only, in index order.
 class UDT_ARRAY : public BASE_CONTAINER {
     protected:
     int index_start;
     int index_end;
+    std::shared_ptr<UDT_SINGLE> prototype;
+    std::pair<int,int> base = {0,0};            ///< Offset of the first element.
+    std::pair<int,int> tail = {0,0};            ///< End of one element, relative to its start.
+    int stride = 0;                             ///< Bytes between the starts of two elements.
+    std::map<int,std::shared_ptr<UDT_ARR_ELEM>> elements;
+    std::vector<bool> hidden;                   ///< Elements hidden by a filter (index - start), empty if none.
+    std::shared_ptr<ElementArena> tree_arena = arena::current();   ///< Arena the elements are built in.
+
+    std::shared_ptr<UDT_ARR_ELEM> _materialize(int index);
+    void _place(int index,UDT_ARR_ELEM& el);
+    void _sync_childs();
 
     public:
     UDT_ARRAY() = default;
     UDT_ARRAY(std::shared_ptr<UDT_ARRAY> el,std::shared_ptr<BASE_CONTAINER> par);
 
-    std::string get_name() const;
-    std::string get_type()const;
+    const std::string& get_name() const;
+    const std::string& get_type()const;
     int get_start()const;
     int get_end()const;
+    int get_count()const;
+    int get_stride()const;
+    std::pair<int,int> get_base()const;
+    std::shared_ptr<UDT_SINGLE> get_prototype()const;
+    std::shared_ptr<UDT_ARR_ELEM> find_element(int index)const;
+    std::shared_ptr<UDT_ARR_ELEM> get_element(int index);
+
+    void set_start(int start_in){index_start = start_in;}
+    void set_end(int end_in){index_end = end_in;}
+    void set_prototype(std::shared_ptr<UDT_SINGLE> proto_in);
+    void set_layout(std::pair<int,int> base_in);
+    void set_child_offset(std::pair<int,int>& actual_offset);
+    void materialize_all();
+    bool get_element_vis(int index)const;
+    void set_element_vis(int index,bool on);
+    void show_all_elements();
     
 
     static std::shared_ptr<UDT_ARRAY> create_from_element
@@ -223,8 +283,8 @@ class STRUCT_SINGLE  : public BASE_CONTAINER {
     STRUCT_SINGLE()=default;
     STRUCT_SINGLE( std::string& name_in,std::string type_in);
     
-    std::string get_name()const;
-    std::string get_type()const;
+    const std::string& get_name()const;
+    const std::string& get_type()const;
 
 
     static std::shared_ptr<STRUCT_SINGLE> create_from_element
@@ -265,8 +325,8 @@ class STRUCT_ARRAY  : public BASE_CONTAINER {
     STRUCT_ARRAY()=default;
     STRUCT_ARRAY( std::string& name_in,std::string type_in) ;
     
-    std::string get_name() const;
-    std::string get_type() const;
+    const std::string& get_name() const;
+    const std::string& get_type() const;
 
     int get_start()const;
     int get_end()const;
@@ -284,28 +344,59 @@ class STRUCT_ARRAY  : public BASE_CONTAINER {
         int end
     );
 };
+namespace Filter{ class SearchIndex; }
+
 class DB : public BASE_CONTAINER{
     protected:
     int default_nr;
     std::pair<int,int> offset_max; 
+
+    std::vector<BASE*> leaves;                  ///< Every leaf, in layout order.
+    std::vector<LeafRecord> layout;             ///< Flat decode table, one record per leaf.
+    std::vector<unsigned char> prev_buffer;     ///< Buffer of the previous decode.
+    std::vector<char> dirty_chunks;             ///< Chunks of prev_buffer that differ from the new buffer.
+    std::vector<BASE*> changed;                 ///< Leaves re-decoded by the last _set_data.
+    std::vector<std::uint64_t> bool_bits;       ///< Value of every Bool leaf, one bit per leaf id.
+    unsigned long data_version = 0;             ///< Bumped by every _set_data whose buffer changed.
+    std::shared_ptr<ElementArena> tree_arena;   ///< Arena holding the nodes of this DB.
+    std::shared_ptr<Filter::SearchIndex> search_index;  ///< Built on the first search, see SearchIndex::of().
+
+    bool _mark_dirty_chunks(const std::vector<unsigned char>& buffer);
+    bool _leaf_changed(const LeafRecord& rec,const std::vector<unsigned char>& buffer)const;
+    void _add_record(BASE* leaf);
+    void _decode(const LeafRecord& rec,const std::vector<unsigned char>& buffer,bool full);
+    void _decode_all(size_t first,size_t count,const std::vector<unsigned char>& buffer);
+    void _decode_bits(size_t first,size_t count,const std::vector<unsigned char>& buffer);
     
     public:
     DB() = default;
     DB(std::string name_in);
 
-    std::string get_name() const;
+    const std::string& get_name() const;
     std::pair<int,int> get_max_offset()const;
+    const std::vector<BASE*>& get_leaves()const;
+    const std::vector<LeafRecord>& get_layout()const;
+    const std::vector<BASE*>& get_changed()const;
+    unsigned long get_data_version()const;
+    const std::vector<std::uint64_t>& get_bool_bits()const;
+    const std::vector<unsigned char>& get_buffer()const;
+    const std::shared_ptr<ElementArena>& get_arena()const;
+    void set_arena(std::shared_ptr<ElementArena> arena_in);
+    const std::shared_ptr<Filter::SearchIndex>& get_search_index()const;
+    void set_search_index(std::shared_ptr<Filter::SearchIndex> index);
     
     void _set_offset();
+    void _build_layout();
     void set_max_offset(std::pair<int,int> ofst);
     void _set_data(const std::vector<unsigned char>& buffer);
+    void _set_data(const std::vector<unsigned char>& buffer,const std::vector<BASE*>& subset,bool force);
     };
 
 namespace Filter
 {
 
     template <class Pred>
-    static bool walk_set_vis(VariantElement el,filterElem* f, Pred pred);
+    static void walk_set_vis(const std::vector<VariantElement>& roots,filterElem* f, Pred pred);
 
     class FilterDB 
     {
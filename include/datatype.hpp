@@ -13,6 +13,8 @@
 #include <filesystem> 
 #include <array>
 #include <cstdlib>
+#include <cstring>
+#include <cstdint>
 #include "snap7.h"
 
 class Element;
@@ -64,13 +66,33 @@ using ScopeVariant =
         std::shared_ptr<STRUCT_SINGLE>
     >;
 
-using Value = std::variant<int, bool, std::string>;
+/// \brief TIA time and date value, in nanoseconds.
+/// \details One representation for TIME/LTIME (a duration), DATE (midnight of the day),
+/// TIME_OF_DAY (since midnight) and DATE_AND_TIME/DTL (since 1970-01-01 00:00).
+struct TimeValue
+{
+    enum class Kind : std::uint8_t { Duration, Date, TimeOfDay, DateTime };
+
+    std::int64_t ns = 0;
+    Kind kind = Kind::Duration;
+
+    bool operator==(const TimeValue& other) const { return ns == other.ns && kind == other.kind; }
+    bool operator!=(const TimeValue& other) const { return !(*this == other); }
+};
+
+/// \brief Decoded value of a leaf.
+/// \details int holds every integer type up to 32 bits except UDInt/DWord; those and the
+/// 64-bit unsigned types are std::uint64_t, LInt is std::int64_t, Real is float and LReal
+/// double. tia::to_string() formats any alternative as TIA shows it.
+using Value = std::variant<int, bool, std::string, std::int64_t, std::uint64_t, float, double, TimeValue>;
 
 class _file_
 {
 public:
     std::string name;
     std::string path;
+    std::uintmax_t size = 0;                        ///< Bytes on disk when the directory was scanned.
+    std::filesystem::file_time_type mtime{};        ///< Last write time when the directory was scanned.
     _file_() = default;
     _file_(std::string n_in) : name(std::move(n_in)) {}
 };
@@ -152,6 +174,24 @@ using Offset = std::pair<int, int>;
 
 enum class Mode { None, Value, Name, ValueName };
 
+/// \brief TIA basic type as a compact code, resolved once when the element is parsed.
+/// \details Sizes and decoders per code live in type_readers.hpp.
+enum class TiaType : std::uint8_t {
+    Bool, Byte, Char, Word, Int, DInt, Real, String, Date,
+    DWord, LReal, SInt, Time, UDInt, UInt, USInt, DateAndTime, DTL,
+    LInt, ULInt, LWord, LTime, TimeOfDay, Unknown
+};
+
+/// \brief One leaf of a DB in the flat layout table built by DB::_set_offset.
+struct LeafRecord
+{
+    std::uint32_t offset = 0;           ///< Byte offset in the DB.
+    std::uint8_t bit = 0;               ///< Bit index, Bool only.
+    TiaType type = TiaType::Unknown;
+    std::uint16_t len = 0;              ///< Size in bytes (0 for Bool).
+    std::uint32_t id = 0;               ///< Index in DB::get_leaves().
+};
+
 std::string to_lowercase(std::string s);
 
 template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
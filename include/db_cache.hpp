@@ -0,0 +1,65 @@
+#pragma once
+
+#include <datatype.hpp>
+#include <string_pool.hpp>
+
+/**
+ * @brief Binary cache of parsed and laid-out DBs.
+ * @details
+ * Parsing a .db export (PEGTL grammar, UDT expansion, offset layout) is the slow part of
+ * opening a DB. After a parse the result is written next to the source as "<name>.dbc":
+ *  - header: magic, parser version, FNV-1a hash of the source file, counts, DB size;
+ *  - string table: every distinct name/type, written once;
+ *  - UDT registry and DB tree as fixed-size node records in pre-order, leaves carrying
+ *    their computed offset; a UDT array is stored as its prototype element.
+ *
+ * On open, the source is hashed and a cache with the same hash and parser version is
+ * memory-mapped and turned back into the element tree, with no parse and no layout.
+ * Any mismatch or malformed file falls back to the parser, which rewrites the cache.
+ * The file uses host byte order; it is a local cache, not an exchange format.
+ */
+
+/// \brief Read-only memory mapping of a whole file.
+class MappedFile
+{
+    private:
+        const unsigned char* ptr = nullptr;
+        std::size_t len = 0;
+        bool open = false;
+#ifdef _WIN32
+        void* file = nullptr;
+        void* mapping = nullptr;
+#else
+        int fd = -1;
+#endif
+
+    public:
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool is_open() const { return open; }
+        const unsigned char* data() const { return ptr; }
+        std::size_t size() const { return len; }
+};
+
+namespace db_cache
+{
+    /// \brief Bump whenever the parser or the layout produce a different tree.
+    constexpr std::uint32_t parser_version = 3;
+
+    /// \brief Extension of cache files ("foo.db" -> "foo.dbc").
+    constexpr const char* extension = ".dbc";
+
+    std::string cache_path(const std::string& source_path);
+
+    std::optional<std::uint64_t> hash_file(const std::string& path);
+
+    std::uint64_t hash_bytes(const unsigned char* p,std::size_t len);
+
+    bool save(const std::string& path,std::uint64_t source_hash,const std::shared_ptr<DB>& db,const UdtRawMap& udts);
+
+    bool load(const std::string& path,std::uint64_t source_hash,std::shared_ptr<DB>& db,UdtRawMap& udts,std::shared_ptr<StringPool> strings);
+};
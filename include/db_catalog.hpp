@@ -0,0 +1,95 @@
+#pragma once
+
+#include <datatype.hpp>
+#include <udt_library.hpp>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+/**
+ * @brief Project-wide catalog of parsed DBs.
+ * @details
+ * At startup every .db file under the project root is loaded on a small thread pool,
+ * each file with its own ParserState (or from its binary cache, see db_cache.hpp); UDT
+ * definitions repeated across files are parsed once (see udt_library.hpp).
+ * Finished DBs are published into a shared catalog keyed by file path, so opening a DB
+ * from the explorer is a lookup instead of a parse. Progress and per-file load times
+ * are available while the indexing runs.
+ *
+ * Entries are immutable once published, except the DB tree itself which, like any open
+ * DB, is only touched by the GUI thread.
+ *
+ * The catalog owns the string pool of the project (see string_pool.hpp). index() starts
+ * over with an empty catalog, UDT library and pool; the previous pool is freed when the
+ * last DB built on it is released.
+ */
+
+/// \brief One DB file of the project.
+struct CatalogEntry
+{
+    std::string path;
+    std::string name;
+    std::shared_ptr<DB> db;
+    UdtRawMap udts;
+    std::uint64_t hash = 0;         ///< Source hash the entry was built from.
+    double load_ms = 0.0;           ///< Parse (or cache load) duration.
+    bool from_cache = false;
+    std::string error;              ///< Empty on success.
+};
+
+/// \brief State of the background indexing.
+struct CatalogProgress
+{
+    std::size_t total = 0;
+    std::size_t done = 0;
+    std::size_t failed = 0;
+    double elapsed_ms = 0.0;
+    bool running = false;
+};
+
+namespace db_catalog
+{
+    CatalogEntry load_file(const std::string& path,const std::string& name,UdtLibrary& library,std::shared_ptr<StringPool> strings);
+
+    void collect_db_files(const _folder_& dir,std::vector<_file_>& out);
+};
+
+class DbCatalog
+{
+    private:
+        std::vector<_file_> files;
+        std::vector<std::thread> workers;
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::atomic<std::size_t> failed{0};
+        std::atomic<bool> cancel{false};
+        std::chrono::steady_clock::time_point started;
+
+        mutable std::mutex mtx;
+        std::map<std::string,std::shared_ptr<const CatalogEntry>> entries;
+        double elapsed_ms = 0.0;
+
+        UdtLibrary udt_library;
+        std::shared_ptr<StringPool> strings = std::make_shared<StringPool>();
+
+        void _work();
+        void _join();
+        void _publish(CatalogEntry entry);
+
+    public:
+        DbCatalog() = default;
+        ~DbCatalog();
+
+        DbCatalog(const DbCatalog&) = delete;
+        DbCatalog& operator=(const DbCatalog&) = delete;
+
+        void index(const _folder_& root,unsigned threads = 0);
+        std::shared_ptr<const CatalogEntry> load(const std::string& path,const std::string& name);
+
+        std::shared_ptr<const CatalogEntry> find(const std::string& path)const;
+        std::vector<std::shared_ptr<const CatalogEntry>> get_entries()const;
+        CatalogProgress get_progress()const;
+        UdtLibraryStats get_udt_stats()const;
+        StringPoolStats get_string_stats()const;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <search_index.hpp>
+#include <handoff.hpp>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+/**
+ * @brief Evaluation of the DB filter off the GUI thread.
+ * @details
+ * The GUI thread submits a FilterQuery: the filter, the SearchIndex of the DB and, for
+ * value filters, a copy of the leaf values (for Bool filters, of the packed Bool values). A worker thread builds the index on its first
+ * query, evaluates the filter into a visibility bitmap and publishes it through a
+ * TripleBuffer. Submitting a newer query cancels the one being evaluated. The GUI thread
+ * fetches the newest result and applies it in one pass with apply(), so the viewer never
+ * shows a half-filtered tree.
+ */
+namespace Filter
+{
+    /// \brief Filter evaluated by the worker.
+    struct FilterQuery
+    {
+        unsigned long seq = 0;
+        filterElem filter;
+        std::shared_ptr<DB> db;
+        std::shared_ptr<SearchIndex> index;     ///< Index of db.
+        std::vector<Value> values;              ///< Leaf values, value filters only.
+        BoolPlane bools;                        ///< Bool leaf values, Bool filters only.
+
+        static std::shared_ptr<FilterQuery> capture(const std::shared_ptr<DB>& db,const filterElem& f);
+    };
+
+    /// \brief Visibility of every node of a query.
+    struct FilterResult
+    {
+        std::shared_ptr<const FilterQuery> query;
+        VisBitmap vis;                          ///< One bit per node of the index.
+        double eval_ms = 0.0;
+    };
+
+    class FilterWorker
+    {
+        private:
+            std::thread worker;
+            std::mutex mtx;
+            std::condition_variable cv;
+
+            std::shared_ptr<const FilterQuery> pending;
+            bool stop_requested = false;
+            std::atomic<unsigned long> latest{0};   ///< Seq of the newest submitted query.
+
+            TripleBuffer<std::shared_ptr<const FilterResult>> handoff;
+
+            void _run();
+            bool _evaluate(const std::shared_ptr<const FilterQuery>& query,FilterResult& out);
+
+        public:
+            FilterWorker();
+            ~FilterWorker();
+
+            FilterWorker(const FilterWorker&) = delete;
+            FilterWorker& operator=(const FilterWorker&) = delete;
+
+            void submit(std::shared_ptr<FilterQuery> q);
+            void cancel();
+
+            std::shared_ptr<const FilterResult> fetch();
+            static void apply(const FilterResult& r,const FilterResult* previous);
+    };
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <managers.hpp>
+#include <unordered_set>
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
@@ -46,6 +47,8 @@ public:
     void Draw();
     void DrawDeviceCombo();
     void DrawDbNr();
+    void DrawPollCycle();
+    void DrawSchedule();
     void DrawNetCardCombo();
     void add_db();
 };
@@ -71,16 +74,39 @@ class FilterBar {
 
 };
 
+/// \brief One line of the DB viewer.
+struct TreeRow
+{
+    enum class Kind { Leaf, Container, ArrayElement };
+
+    VariantElement el;      ///< Node of the row; the UDT_ARRAY for an ArrayElement row.
+    Kind kind;
+    int depth;
+    int index = 0;          ///< Array index of an ArrayElement row.
+};
+
 class Body {
 public:
     Body()=default;
     Body(MainGUIController* main);
-    void Draw_node(const VariantElement& element,int&depth_in);
     void Draw_Explorer();
     void Draw_DirectoryTree(const FileFolderVar& el);
+    void Draw_Folder(const _folder_& f);
+    void Draw_File(const _file_& f);
     void Draw(const std::shared_ptr<DB>& db);
 private:
+    void _build_rows(const std::shared_ptr<DB>& db);
+    void _add_rows(const VariantElement* first,std::size_t count,int depth);
+    void _draw_row(const TreeRow& row);
+
     std::string current_filter;
+    std::vector<VariantElement> shown;      ///< Leaves on screen in the current frame.
+    std::vector<TreeRow> rows;              ///< Visible tree flattened, open containers expanded.
+    std::unordered_set<const void*> open_nodes; ///< Expanded containers (node addresses).
+    const DB* rows_db = nullptr;            ///< DB the rows were built for.
+    unsigned long rows_tree_gen = 0;        ///< class_utils::tree_generation() of the rows.
+    unsigned long rows_vis_gen = 0;         ///< class_utils::vis_generation() of the rows.
+    bool rows_dirty = true;                 ///< A node was opened or closed.
     MainGUIController* this_controller;
 };
 
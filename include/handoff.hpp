@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Lock-free "latest value" handoff between one producer and one consumer thread.
+ * @details
+ * Classic triple buffer: the producer owns the back slot, the consumer owns the front
+ * slot and the middle slot is swapped atomically. Neither side ever blocks or waits;
+ * the consumer always sees the most recent complete value and older ones are dropped.
+ *
+ * @code
+ * // producer                         // consumer
+ * T& s = tb.write_slot();             if (const T* s = tb.fetch())
+ * fill(s);                                use(*s);
+ * tb.publish();
+ * @endcode
+ */
+template<typename T>
+class TripleBuffer
+{
+    private:
+        static constexpr uint8_t index_mask = 0x03;
+        static constexpr uint8_t dirty_bit  = 0x04;
+
+        std::array<T,3> slots{};
+        std::atomic<uint8_t> middle{1};
+        uint8_t back  = 0;      ///< Producer-owned slot index.
+        uint8_t front = 2;      ///< Consumer-owned slot index.
+
+    public:
+        TripleBuffer() = default;
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        /// \brief Slot the producer fills before calling publish(); reused across cycles.
+        T& write_slot() { return slots[back]; }
+
+        /// \brief Makes the back slot visible to the consumer and recycles the middle one.
+        void publish()
+        {
+            uint8_t prev = middle.exchange(static_cast<uint8_t>(back | dirty_bit), std::memory_order_acq_rel);
+            back = prev & index_mask;
+        }
+
+        /// \brief Takes the newest published value, if any arrived since the last fetch.
+        /// \return Pointer valid until the next fetch(), or nullptr when nothing new.
+        const T* fetch()
+        {
+            if (!(middle.load(std::memory_order_acquire) & dirty_bit)) return nullptr;
+            uint8_t prev = middle.exchange(front, std::memory_order_acq_rel);
+            front = prev & index_mask;
+            return &slots[front];
+        }
+
+        /// \brief Last value returned by fetch() (default constructed before the first one).
+        const T& read_slot() const { return slots[front]; }
+};
+
+/**
+ * @brief Lock-free bounded FIFO between one producer and one consumer thread.
+ * @details
+ * Unlike TripleBuffer every value is delivered, in order. The producer owns \c tail and
+ * the consumer owns \c head; each side only reads the other's index, so push() and pop()
+ * never block. A full ring makes push() fail rather than overwrite or wait.
+ *
+ * @code
+ * // producer                         // consumer
+ * if (!ring.push(std::move(v)))       T v;
+ *     ++dropped;                      while (ring.pop(v)) use(v);
+ * @endcode
+ */
+template<typename T,std::size_t N>
+class SpscRing
+{
+    private:
+        static_assert(N > 0 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+        std::array<T,N> slots{};
+        alignas(64) std::atomic<std::size_t> head{0};  ///< Next slot to pop, consumer-owned.
+        alignas(64) std::atomic<std::size_t> tail{0};  ///< Next slot to push, producer-owned.
+
+    public:
+        SpscRing() = default;
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        /// \brief Appends \p v; producer thread only.
+        /// \return false (and \p v is left untouched) when the ring is full.
+        bool push(T&& v)
+        {
+            const std::size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) == N) return false;
+            slots[t & (N - 1)] = std::move(v);
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// \brief Takes the oldest value into \p out; consumer thread only.
+        /// \return false when the ring is empty.
+        bool pop(T& out)
+        {
+            const std::size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) return false;
+            out = std::move(slots[h & (N - 1)]);
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+};
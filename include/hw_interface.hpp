@@ -8,9 +8,47 @@ namespace fs = std::filesystem;
 namespace folders
 {
     std::map<std::string, DbInfo> get_dbs();
+
+    std::string root_path();
     
     _folder_ get_instances();
 
-    void walk_dir(_folder_& dir, const std::string& path, std::string& f_path);
+    void walk_dir(_folder_& dir, const std::string& path, const std::string& f_path);
+
+};
+
+/**
+ * @brief Cached model of the project directory (`<cwd>/root`).
+ * @details
+ * The directory is walked once when opened and again only when it changes: on Linux an
+ * inotify descriptor watches every folder of the tree and poll(), called once per frame,
+ * drains its events without blocking; elsewhere (and at any time) refresh() rescans on
+ * request. Events on parsed-DB caches and their temporary files are ignored, so indexing
+ * does not trigger rescans.
+ *
+ * A scan builds a new immutable tree; get() hands out the current one, so a tree being
+ * drawn is never modified.
+ */
+class ProjectDirectory
+{
+    private:
+        std::shared_ptr<const _folder_> tree = std::make_shared<const _folder_>("Projects");
+        unsigned long version = 0;
+        int notify_fd = -1;
+
+        void _scan();
+        void _watch(const _folder_& dir);
+
+    public:
+        ProjectDirectory() = default;
+        ProjectDirectory(const ProjectDirectory&) = delete;
+        ProjectDirectory& operator=(const ProjectDirectory&) = delete;
+        ~ProjectDirectory();
+
+        void open();
+        bool poll();
+        void refresh();
 
+        std::shared_ptr<const _folder_> get()const;
+        unsigned long get_version()const;
 };
\ No newline at end of file
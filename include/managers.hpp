@@ -4,26 +4,41 @@
 #include <memory>
 #include <classes.hpp>
 #include <profi_DCP.hpp>
+#include <plc_connection.hpp>
+#include <poller.hpp>
+#include <filter_worker.hpp>
+#include <scheduler.hpp>
+#include <subscriptions.hpp>
+#include <db_cache.hpp>
+#include <db_catalog.hpp>
+#include <hw_interface.hpp>
 
 class NetManager {
     private:    
         
-        TS7Client Client;
+        ConnectionPool pool;
         profinet::PcapClient network;
         std::optional<std::string> ip_selected = std::nullopt;
-        std::vector<profinet::DCP_Device> devices;
+        int rack = 0;
+        int slot = 1;
 
     public:
         NetManager();   
 
         void scan_network();
+        void replay_capture(const std::string& pcap_path);
+        void update();
+        bool is_scanning()const;
         
         const std::map<std::string,std::string> get_netCards();
-        std::vector<profinet::DCP_Device>* get_devices();
+        const std::vector<profinet::DCP_Device>* get_devices()const;
         const std::optional<std::string> get_ip();
+        std::optional<PlcKey> get_plc_key() const;
+        std::optional<ConnectionStats> get_connection_stats() const;
+        ConnectionPool& get_pool();
 
         void plc_data_retrieve(int db_nr,int size,std::vector<unsigned char>* buffer);
-        bool plc_data_send(int db_nr,int size,std::vector<unsigned char> buffer ) ;
+        bool plc_data_send(int db_nr,const ByteRange& range,std::vector<unsigned char>& image);
         void set_netCard(std::string card);
         void set_ip(std::string ip);
 };
@@ -31,7 +46,15 @@ class NetManager {
 class DatabaseManager {
     protected:
         std::shared_ptr<DB> database = nullptr;
+        UdtRawMap udt_database;
+        DbCatalog catalog;
         DbInfo db_scope;
+        SharedRanges read_ranges;
+        SubscriptionRegistry subscriptions;
+        unsigned long decoded_version = 0;
+        int merge_gap = read_planner::default_merge_gap;
+
+        void _plan_reads();
 
     public:
         DatabaseManager()=default;
@@ -45,42 +68,92 @@ class DatabaseManager {
         int get_db_default_number()const;     
         int get_db_size()const;
         std::shared_ptr<DB> get_db();
+        const UdtRawMap& get_udts()const;
+        const DbCatalog& get_catalog()const;
+        SharedRanges get_read_ranges()const;
+        SharedRanges get_subscribed_ranges();
+        SubscriptionRegistry& get_subscriptions();
+        const std::vector<BASE*>& get_changed_leaves()const;
+        int get_merge_gap()const;
 
         //Setter
         void set_db_nr(int* nr_in);
         void set_db_scope(DbInfo key);
+        void index_project(const _folder_& root);
         void set_db_data(const std::vector<unsigned char> buffer);
+        void set_merge_gap(int gap);
 };
 
 class FilterManager{
     protected:
-        std::shared_ptr<DB> db_ptr;
-        std::unique_ptr<Filter::FilterDB> filter;
+        std::shared_ptr<DB> db_ptr;                 ///< DB of the last query.
         Filter::filterElem filters;
+        Filter::FilterWorker worker;
+        bool active = false;                        ///< The filter bar is on.
+        std::shared_ptr<const Filter::FilterResult> applied;   ///< Result on screen, null after a reset.
+        unsigned long query_data_version = 0;       ///< DB::get_data_version() of the last query.
+        unsigned long applied_tree_gen = 0;         ///< class_utils::tree_generation() when applied was applied.
+
+        void _submit(const std::shared_ptr<DB>& db);
 
     public:
         void set_mode(std::shared_ptr<DB>);
         void reset_mode();
+        void update(const std::shared_ptr<DB>& db);
         Filter::filterElem* get_filter();
         
 };
 
 class CommManager
 {
+    protected:
+        std::optional<PollConfig> poll_config;
+        int poll_cycle_ms = 100;
+        double last_cycle_ms = 0.0;
+        int last_result = 0;
+
+        ProjectDirectory project;
+
+        std::map<PlcKey,PlcSnapshot> plc_images;    ///< Newest image of every scheduled PLC.
+        std::optional<std::pair<PlcKey,unsigned long>> shown_image;    ///< Scheduled image loaded in DataMan.
+        std::optional<PlcKey> image_key;            ///< PLC \c buffer is an image of.
+        const DB* image_db = nullptr;               ///< DB \c buffer is an image of.
+        int image_db_nr = 0;
+
+        std::optional<PollConfig> _make_poll_config();
+        bool _sync_poll_config();
+        void _sync_filter_subscription();
+        void _fetch_schedule();
+        bool _show_scheduled();
+        void _merge_image(const PlcKey& key,const DbSnapshot& snap);
+
     public:
-        std::vector<unsigned char> buffer;
+        std::vector<unsigned char> buffer;          ///< Image of the selected DB; only read ranges are valid.
         DatabaseManager DataMan;
         NetManager NetMan;
         FilterManager FilMan;
+        CyclicPoller Poller{&NetMan.get_pool()};
+        AcquisitionScheduler Scheduler{&NetMan.get_pool()};
 
         CommManager();
         ~CommManager();  
 
         void get_plc_data();
-        _folder_ get_directory();
-
-        void set_plc_data();
+        void update();
+        std::shared_ptr<const _folder_> get_directory()const;
+        int get_poll_cycle()const;
+        double get_last_cycle()const;
+        int get_last_result()const;
+        bool is_polling();
+        const std::map<PlcKey,PlcSnapshot>& get_plc_images()const;
+
+        void set_plc_data(const BASE& leaf);
         void set_filter_mode();
+        void refresh_directory();
+        void set_poll_cycle(int cycle_ms);
+        void start_polling();
+        void stop_polling();
+        void schedule_all_devices();
+        void clear_schedule();
 
 };
-
@@ -83,8 +83,10 @@
  * - Transient fields (name/type/array) are cleared after each ';'.
  * - udt_database enables UDT references within DB bodies.
  *
- * @note Endianness & sizes are handled when decoding values via `translate::*` and
- *       the `tia_type_size` lookup (see classes.cpp). Adjust to your PLC data format.
+ * @note Files are normally not parsed as one complete_datablock: udt_library.hpp cuts them
+ *       into udt_block and db_section pieces so that UDTs shared between files are parsed once.
+ * @note Type names are resolved to a TiaType when the element is created; sizes and
+ *       big-endian decoders per type live in type_readers.hpp.
  * @note If you change quoting/normalization of names in grammar, keep actions consistent
  *       (e.g., UDT detection vs. standard types).
  */
@@ -210,6 +212,19 @@ struct complete_datablock : pt::seq<
     db_footer
     >{};
 
+/// \brief A single `TYPE ... END_TYPE` block cut out of a file (see udt_library.hpp).
+struct udt_block : pt::seq<
+    udt_raw_header,
+    pt::eof
+    >{};
+
+/// \brief The DB part of a file (`DATA_BLOCK` to the end), parsed after its UDTs were resolved.
+struct db_section : pt::seq<
+    db_header,
+    pt::plus<db_body>,
+    db_footer
+    >{};
+
 
 // ===================== UDTs DATABASE =====================
 
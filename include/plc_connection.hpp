@@ -0,0 +1,107 @@
+#pragma once
+
+#include <datatype.hpp>
+#include <read_planner.hpp>
+#include <mutex>
+#include <chrono>
+
+/**
+ * @brief Persistent S7 sessions shared by every read/write path.
+ * @details
+ * Opening an ISO-on-TCP + S7 session costs a full handshake (TCP connect,
+ * COTP connection request, S7 setup communication). The pool keeps one
+ * TS7Client per PLC endpoint alive between requests:
+ *  - Sessions are keyed by IP/rack/slot and created lazily on first use.
+ *  - Every request checks the session health and reconnects when needed.
+ *  - A transport failure drops the session and retries the request once.
+ *  - Handshake and read/write latencies are tracked per connection.
+ */
+
+/// \brief Identifies a PLC endpoint (IP + rack + slot).
+struct PlcKey
+{
+    std::string ip;
+    int rack = 0;
+    int slot = 1;
+
+    bool operator<(const PlcKey& other) const;
+    bool operator==(const PlcKey& other) const;
+    std::string to_string() const;
+};
+
+/// \brief Latency and health counters of a single pooled connection.
+struct ConnectionStats
+{
+    double handshake_ms = 0.0;      ///< Duration of the last successful ConnectTo.
+    double last_read_ms = 0.0;      ///< Duration of the last read request.
+    double avg_read_ms = 0.0;       ///< Moving average of read duration.
+    double last_write_ms = 0.0;     ///< Duration of the last write request.
+    int last_read_bytes = 0;        ///< Data bytes transferred by the last read.
+    int last_read_requests = 0;     ///< Requests (PDUs) issued by the last read.
+    unsigned long connects = 0;     ///< Number of handshakes performed.
+    unsigned long reads = 0;        ///< Successful read requests.
+    unsigned long writes = 0;       ///< Successful write requests.
+    unsigned long errors = 0;       ///< Failed requests (after retry).
+    int pdu_length = 0;             ///< Negotiated PDU length, 0 if never connected.
+    int last_error = 0;             ///< Last snap7 error code.
+    bool connected = false;
+};
+
+/// \brief One persistent S7 session; all calls are serialized by an internal mutex.
+/// \details get_stats() does not take that mutex: it returns a copy of the counters
+/// published after each call under a small lock of its own, so it never waits for a
+/// request in flight.
+class PlcConnection
+{
+    private:
+        PlcKey key;
+        TS7Client client;
+        ConnectionStats stats;              ///< Updated under \c mtx during a request.
+        std::vector<TS7DataItem> items;
+        mutable std::mutex mtx;
+        ConnectionStats published;          ///< Copy of \c stats for get_stats().
+        mutable std::mutex stats_mtx;
+
+        struct PublishGuard;
+
+        void _publish();
+        bool _ensure_connected();
+        void _drop();
+        static bool _is_transport_error(int res);
+        void _record_read(std::chrono::steady_clock::time_point t0,int bytes,int requests);
+        int _read_plan(int db_nr,const ReadPlan& plan,unsigned char* dst);
+
+    public:
+        explicit PlcConnection(PlcKey key_in);
+        ~PlcConnection();
+
+        PlcConnection(const PlcConnection&) = delete;
+        PlcConnection& operator=(const PlcConnection&) = delete;
+
+        int read(int db_nr,int start,int size,unsigned char* dst);
+        int read_ranges(int db_nr,const std::vector<ByteRange>& ranges,unsigned char* dst);
+        int write(int db_nr,int start,int size,unsigned char* src);
+        bool is_healthy();
+        void disconnect();
+
+        const PlcKey& get_key() const;
+        ConnectionStats get_stats() const;
+};
+
+/// \brief Pool of persistent sessions keyed by PLC endpoint.
+class ConnectionPool
+{
+    private:
+        std::map<PlcKey,std::shared_ptr<PlcConnection>> connections;
+        mutable std::mutex mtx;
+
+    public:
+        ConnectionPool() = default;
+        ~ConnectionPool();
+
+        std::shared_ptr<PlcConnection> acquire(const PlcKey& key);
+        void remove(const PlcKey& key);
+        void release_all();
+
+        std::vector<std::pair<PlcKey,ConnectionStats>> get_stats() const;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <datatype.hpp>
+#include <plc_connection.hpp>
+#include <handoff.hpp>
+#include <thread>
+#include <condition_variable>
+
+/**
+ * @brief Background acquisition of one DB, decoupled from the ImGui frame loop.
+ * @details
+ * A worker thread reads the configured DB through the connection pool, either
+ * once on request or cyclically (e.g. 50 ms, 100 ms, 1 s), and publishes each raw
+ * DB image through a TripleBuffer. The GUI thread picks up the newest snapshot
+ * with fetch() and decodes it into the DB tree; it never waits on the network.
+ */
+
+/// \brief What the poller reads and how often.
+struct PollConfig
+{
+    PlcKey key;
+    int db_nr = 0;
+    int size = 0;
+    SharedRanges ranges;                    ///< Needed byte ranges (see read_planner), null = whole DB.
+    std::chrono::milliseconds cycle{0};     ///< 0 = only on request_once().
+
+    bool same_target(const PollConfig& other) const;
+};
+
+/// \brief One DB image produced by the poller.
+struct DbSnapshot
+{
+    std::vector<unsigned char> buffer;
+    PlcKey key;
+    int db_nr = 0;
+    SharedRanges ranges;            ///< Ranges that were read, null = whole DB.
+    int result = 0;                 ///< snap7 result of the read (0 = ok).
+    unsigned long seq = 0;          ///< Monotonic snapshot counter.
+    double read_ms = 0.0;           ///< Duration of the read.
+    double cycle_ms = 0.0;          ///< Achieved time since the previous cyclic read.
+    std::chrono::steady_clock::time_point stamp;
+};
+
+class CyclicPoller
+{
+    private:
+        ConnectionPool* pool;
+        std::thread worker;
+        std::mutex mtx;
+        std::condition_variable cv;
+
+        PollConfig config;
+        bool has_config = false;
+        bool cyclic = false;
+        bool once_requested = false;
+        bool stop_requested = false;
+
+        TripleBuffer<DbSnapshot> handoff;
+        unsigned long seq = 0;
+
+        void _run();
+        void _read(const PollConfig& cfg,std::chrono::steady_clock::time_point last_start);
+
+    public:
+        explicit CyclicPoller(ConnectionPool* pool_in);
+        ~CyclicPoller();
+
+        CyclicPoller(const CyclicPoller&) = delete;
+        CyclicPoller& operator=(const CyclicPoller&) = delete;
+
+        void configure(const PollConfig& cfg);
+        void start();
+        void stop();
+        void request_once();
+
+        bool is_running();
+        std::optional<PollConfig> get_config();
+
+        const DbSnapshot* fetch();
+};
@@ -22,6 +22,7 @@
 #endif
 
 #include <datatype.hpp>
+#include <handoff.hpp>
 #include <random>
 #include <stdexcept>
 #include <cstring>
@@ -30,18 +31,37 @@
 #include <sys/types.h>
 #include <chrono>
 #include <sstream>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
 
 /**
  * @brief Profinet DCP discovery and packet utilities.
  * @details
  * Implements a minimal Profinet DCP Identify workflow using libpcap:
  *  - Build and send a DCP Identify request (EtherType 0x8892)
- *  - Sniff replies and extract device metadata (MAC, IP, StationName, Family)
- *  - Expose discovered devices to the rest of the app
+ *  - Sniff replies on a capture thread and extract device metadata (MAC, IP, StationName, Family)
+ *  - Hand the devices to the GUI thread through a lock-free queue
  */
 namespace profinet
 {
 
+    /* ------------------ Byte View ------------------ */
+
+    /**
+     * @brief Non-owning view of bytes inside a captured frame.
+     * @details Valid as long as the frame buffer (the pcap packet) is.
+     */
+    struct ByteView
+    {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+
+        const uint8_t* begin() const { return data; }
+        const uint8_t* end() const { return data + size; }
+        bool empty() const { return size == 0; }
+    };
+
     /* ---------------- IP Parameters ---------------- */
 
 
@@ -56,16 +76,16 @@ namespace profinet
         std::string mask;
         std::string gateway;
         public:
-        static std::optional<IPParams> create(const std::vector<uint8_t>& body) {
-            if (body.size() < 12) 
+        static std::optional<IPParams> create(ByteView body) {
+            if (body.size < 12) 
             {
-                std::cerr<<"ip too short "<<std::to_string(body.size())<<"\n";
+                std::cerr<<"ip too short "<<std::to_string(body.size)<<"\n";
                 return std::nullopt;
             }
             IPParams p;
-            p.ip       = to_ipv4(&body[0]);
-            p.mask     = to_ipv4(&body[4]);
-            if (body.size() > 12) p.gateway  = to_ipv4(&body[8]);
+            p.ip       = to_ipv4(body.data);
+            p.mask     = to_ipv4(body.data + 4);
+            p.gateway  = to_ipv4(body.data + 8);
             return p;
         }
         
@@ -81,7 +101,8 @@ namespace profinet
     /* -------------------- TLV ---------------------- */
 
     /**
-     * @brief Simple DTO for a TLV package.
+     * @brief One DCP block (option, suboption, length, body), viewed in place.
+     * @details The body excludes the 2-byte BlockInfo that leads every response block.
      */
     class TLV
     {
@@ -89,16 +110,33 @@ namespace profinet
             uint8_t option;
             uint8_t sub_option;
             int len;
-            std::vector<uint8_t> body;
+            ByteView body;
         public:
         
-            TLV(uint8_t opt, uint8_t sub_opt,int len);  
-            uint8_t get_option();
-            uint8_t get_suboption();
-            int get_len();
-            const std::vector<uint8_t>& get_body();
+            TLV(uint8_t opt, uint8_t sub_opt,int len,ByteView body);
+            uint8_t get_option()const;
+            uint8_t get_suboption()const;
+            int get_len()const;
+            ByteView get_body()const;
+    };
 
-            static std::optional<TLV> create(std::vector<uint8_t>& bt);
+    /**
+     * @brief Bounds-checked cursor over the block list of a DCP frame.
+     * @details Yields TLV views into the frame, without copying or allocating; a block
+     * that would run past the end of the list stops the walk and sets failed().
+     */
+    class TLVCursor
+    {
+        private:
+            const uint8_t* pos;
+            const uint8_t* end;
+            bool error = false;
+        public:
+            explicit TLVCursor(ByteView blocks);
+
+            /// @brief Next block, std::nullopt at the end of the list or on a malformed block.
+            std::optional<TLV> next();
+            bool failed()const;
     };
 
     /* ----------------- DCP Device ------------------ */
@@ -134,25 +172,62 @@ namespace profinet
         /// @return true if Family contains "plc" (case-insensitive) or key fields are present.
         bool isPLC();
 
-        void add_TLV(TLV tlv);
+        void add_TLV(const TLV& tlv);
+    };
+
+    /// \brief Devices parsed by the capture thread, waiting for the GUI thread.
+    using DeviceQueue = SpscRing<DCP_Device,512>;
+
+    /* ---------------- Device Table ----------------- */
+
+    /**
+     * @brief Devices discovered on the network, one row per MAC address.
+     * @details Lookups by MAC, IP and station name are hashed and a device that answers again is
+     * updated in place. New or renamed devices are appended; the rows are sorted by station
+     * name (then MAC) lazily, once per batch, by the next get_rows().
+     */
+    class DeviceTable
+    {
+        private:
+            mutable std::vector<DCP_Device> rows;                           ///< Sorted by name, then MAC, unless dirty.
+            mutable std::unordered_map<std::string,size_t> row_by_mac;
+            std::unordered_map<std::string,std::string> mac_by_ip;
+            std::unordered_map<std::string,std::string> mac_by_name;
+            mutable bool sorted = true;
+
+            void _index_ip(const DCP_Device& dev,const std::string& mac);
+            void _index_name(const DCP_Device& dev,const std::string& mac);
+        public:
+            /// @brief Adds \p dev, or replaces the row with the same MAC.
+            void upsert(DCP_Device dev);
+
+            const DCP_Device* find_mac(const std::string& mac)const;
+            const DCP_Device* find_ip(const std::string& ip)const;
+            const DCP_Device* find_name(const std::string& name)const;
+            const std::vector<DCP_Device>& get_rows()const;
+            size_t size()const;
     };
 
     /* ------------------ Sniffer -------------------- */
 
     /**
-     * @brief Thin wrapper around pcap_loop to collect PN-DCP responses.
-     * @details Non-owning: it writes results into an external vector passed in ctor.
+     * @brief Thin wrapper around pcap_dispatch to collect PN-DCP responses.
+     * @details Runs on the capture thread: every PLC-like reply is pushed to a DeviceQueue.
      */
     class PackageParser {
     public:
     
-        /// @brief Start capturing on the given pcap handle; calls onPacket per frame.
-        void start();
+        /// @brief Process the frames pending on the pcap handle; calls onPacket per frame.
+        /// @return pcap_dispatch result (frames processed, or PCAP_ERROR/PCAP_ERROR_BREAK).
+        int start();
 
-        /// @brief Construct a sniffer that appends results into \p _objs .
-        PackageParser(std::shared_ptr<std::vector<profinet::DCP_Device>> _objs,bool* _lock,pcap_t* handle);
+        /// @brief Construct a sniffer that pushes results into \p _out .
+        /// @param _stop If set, a full queue is waited on (until *_stop) instead of dropping.
+        PackageParser(DeviceQueue* _out,pcap_t* handle,const std::atomic<bool>* _stop = nullptr);
         PackageParser() = default;
 
+        size_t get_dropped()const;
+
     private:
 
 
@@ -162,12 +237,28 @@ namespace profinet
         /// @brief User-defined callback: parse a single captured frame.
         void onPacket(const pcap_pkthdr* h, const u_char* bytes) ;
         
-        std::shared_ptr<std::vector<profinet::DCP_Device>> objs;  ///< External results vector (non-owning).
-        bool* lock;
+        DeviceQueue* out = nullptr;     ///< Queue read by the GUI thread (non-owning).
+        const std::atomic<bool>* stop = nullptr;
         pcap_t* handle_ = nullptr;      ///< Active pcap handle.
         size_t  packets_ = 0;           ///< Packets processed.
+        size_t  dropped_ = 0;           ///< Devices lost because the queue was full.
     };
 
+    /// @brief Parses every frame of a capture file repeatedly and prints frames/s, then
+    /// replays the file once through PackageParser and a DeviceTable.
+    /// @param expected Devices the replay must list, negative to skip the check.
+    /// @return 0 on success, 1 if the file cannot be read, the replay dropped devices or
+    /// listed a count other than \p expected.
+    int bench_parser(const std::string& pcap_path,long expected = -1);
+
+    /// @brief Largest fleet write_fleet() can give distinct MACs and IPs (24 bits).
+    constexpr int max_fleet = 0xFFFFFF;
+
+    /// @brief Writes Identify responses of \p count synthetic PLCs to a pcap file.
+    /// @return 0 on success, 1 if \p count is outside [1,max_fleet] or the file cannot be
+    /// written.
+    int write_fleet(const std::string& pcap_path,int count);
+
     /* ---------------- Pcap Client ------------------ */
     
     /**
@@ -181,15 +272,19 @@ namespace profinet
     class PcapClient
     {
     private:
-        pcap_t* live_process;
+        pcap_t* live_process = nullptr;     ///< Handle of the running scan, guarded by handle_mtx.
+        std::mutex handle_mtx;
         std::string net_card = "";
         std::map<std::string,std::string> net_cards;
         std::array<uint8_t,6> mac_addr{};
         std::array<uint8_t,4> XID{};
-        std::shared_ptr<std::vector<profinet::DCP_Device>> devices;
-        std::optional<PackageParser> parser;
-        
-        std::optional<std::chrono::steady_clock::time_point> time_out;
+
+        std::thread capture;                ///< Owns live_process while a scan runs.
+        std::atomic<bool> scanning{false};
+        std::atomic<bool> stop_requested{false};
+        bool offline = false;               ///< live_process reads a capture file.
+        DeviceQueue found;                  ///< Capture thread -> GUI thread.
+        DeviceTable devices;                ///< GUI side.
         
         char errbuf[PCAP_ERRBUF_SIZE];
         
@@ -205,20 +300,43 @@ namespace profinet
         /// @brief Install a BPF filter (EtherType 0x8892 for Profinet).
         void _set_filter(pcap_t* process);
 
-        bool lock;
+        /// @brief Capture thread: parses replies until the scan window ends or a stop.
+        void _capture(std::chrono::steady_clock::time_point deadline);
+
+        /// @brief Hands \p process to a new capture thread.
+        void _start(pcap_t* process,bool from_file);
+
+        /// @brief Ends the running scan, if any, and joins the capture thread.
+        void _stop();
+
     public:
+        /// @brief How long a scan listens for Identify replies.
+        static constexpr std::chrono::seconds scan_window{5};
         
         /// @brief Construct and cache network interface list.
         PcapClient();
-        ~PcapClient()=default;
+        ~PcapClient();
+
+        PcapClient(const PcapClient&) = delete;
+        PcapClient& operator=(const PcapClient&) = delete;
         
-        /// @brief Send a DCP Identify and collect responses.
+        /// @brief Send a DCP Identify and start collecting responses on the capture thread.
         /// @return 0 on success; PCAP_ERROR on failure.
         int identifyAll();
+
+        /// @brief Feed the capture thread from a .pcap file instead of the selected NIC.
+        /// @return 0 on success; PCAP_ERROR if the file cannot be opened.
+        int replay(const std::string& pcap_path);
+
+        /// @brief Moves the devices found so far into the device list. GUI thread only.
+        void collect();
         
-        /// @brief Get last discovered device list (if any).
-        const std::shared_ptr<std::vector<profinet::DCP_Device>> get_devices();
-        const bool get_lock()const;
+        /// @brief Devices discovered so far, as of the last collect().
+        const std::vector<profinet::DCP_Device>& get_devices()const;
+
+        /// @brief True while the capture thread is listening for replies.
+        bool is_scanning()const;
+
         /// @brief Map of "idx: friendly name" -> pcap adapter string.
         std::map<std::string,std::string> get_cards();
         
@@ -290,6 +408,12 @@ class packageHelper
         /// @return A 60-byte frame ready for pcap_sendpacket().
         static std::array<uint8_t,60> build_DCP(std::array<uint8_t,6>* mac_address,std::array<uint8_t,4>& XID);
 
+        /// @brief Build a PN-DCP Identify response frame, as a PLC would answer.
+        /// @details Carries the Family (2/1), StationName (2/2) and IP (1/2) blocks.
+        static std::vector<uint8_t> build_DCP_response(const std::array<uint8_t,6>& mac_address,const std::array<uint8_t,4>& XID,
+                                                      const std::string& family,const std::string& station,
+                                                      const std::array<uint8_t,4>& ip);
+
     private:
         
         static const int frame_len = 60;
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <datatype.hpp>
+
+/**
+ * @brief Plans DB reads as a minimal set of byte ranges packed into PDU-sized requests.
+ * @details
+ * Planning runs in two steps:
+ *  1) merge(): field ranges (from the offsets computed by DB::_set_offset) are sorted and
+ *     coalesced; two ranges are merged when the gap between them is at most \c merge_gap
+ *     bytes, since reading a few unused bytes is cheaper than another request item.
+ *     This depends only on the DB layout and the needed fields, so it is done once.
+ *  2) plan(): merged ranges are split so each fits one response item and packed into
+ *     ReadMultiVars batches that respect both the item limit and the negotiated PDU.
+ *     This depends on the session, so it is done by the connection before reading.
+ *
+ * S7 "read var" framing used for the PDU budget:
+ *  - request : 12 bytes header/params + 12 bytes per item
+ *  - response: 14 bytes header/params + 4 bytes per item + data (odd sizes padded)
+ */
+
+/// \brief Contiguous byte range [start, start+size) of a DB.
+struct ByteRange
+{
+    int start = 0;
+    int size = 0;
+
+    int end() const { return start + size; }
+};
+
+/// \brief One ReadMultiVars request.
+struct ReadBatch
+{
+    std::vector<ByteRange> items;
+};
+
+/// \brief Batches to execute for one DB read.
+struct ReadPlan
+{
+    std::vector<ReadBatch> batches;
+    int total_bytes = 0;        ///< Bytes transferred (data only).
+};
+
+using SharedRanges = std::shared_ptr<const std::vector<ByteRange>>;
+
+namespace read_planner
+{
+    /// \brief Default gap (bytes) below which adjacent ranges are merged.
+    constexpr int default_merge_gap = 16;
+
+    constexpr int request_header = 12;
+    constexpr int request_item   = 12;
+    constexpr int response_header = 14;
+    constexpr int response_item  = 4;
+
+    ByteRange field_range(const BASE& leaf);
+
+    void collect_fields(const VariantElement& el,std::vector<ByteRange>& out);
+
+    std::vector<ByteRange> collect_fields(const std::shared_ptr<DB>& db);
+
+    std::vector<ByteRange> merge(std::vector<ByteRange> fields,int merge_gap = default_merge_gap);
+
+    ReadPlan plan(const std::vector<ByteRange>& merged,int pdu_length,int max_items = MaxVars);
+
+    int max_item_payload(int pdu_length);
+};
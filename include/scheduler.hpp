@@ -0,0 +1,109 @@
+#pragma once
+
+#include <datatype.hpp>
+#include <plc_connection.hpp>
+#include <poller.hpp>
+#include <queue>
+
+/**
+ * @brief Concurrent acquisition from many PLCs, each with its own DB list and cycle time.
+ * @details
+ * Jobs (one per PLC endpoint) are dispatched earliest-deadline-first to a fixed pool of
+ * worker threads. A job is out of the ready queue while one worker reads it, so a slow
+ * or unreachable CPU holds at most one worker and never delays the deadlines of the
+ * others. When a job overruns its cycle the missed periods are skipped, not queued.
+ *
+ * Each job publishes its DB images through its own TripleBuffer, so the GUI can pick
+ * the newest snapshot of any PLC without blocking. CommManager fetches them once per frame
+ * into its per-PLC images and shows the selected PLC from there when it is scheduled, so a
+ * scheduled PLC is not also read by CyclicPoller.
+ */
+
+/// \brief One DB read by a scheduled job.
+struct DbRequest
+{
+    int db_nr = 0;
+    int size = 0;
+    SharedRanges ranges;        ///< Needed byte ranges (see read_planner), null = whole DB.
+};
+
+/// \brief What to read from one PLC and how often.
+struct PlcJobConfig
+{
+    PlcKey key;
+    std::vector<DbRequest> dbs;
+    std::chrono::milliseconds cycle{100};
+};
+
+/// \brief Requested vs. achieved timing of one job.
+struct PlcCycleStats
+{
+    PlcKey key;
+    double requested_ms = 0.0;      ///< Configured cycle time.
+    double achieved_ms = 0.0;       ///< Moving average of start-to-start time.
+    double last_duration_ms = 0.0;  ///< Time spent reading all DBs of the last cycle.
+    double max_lateness_ms = 0.0;   ///< Worst start delay behind the deadline.
+    unsigned long cycles = 0;
+    unsigned long overruns = 0;     ///< Cycles whose next deadline had already passed.
+    unsigned long errors = 0;       ///< Cycles with at least one failed DB read.
+    int last_result = 0;
+};
+
+/// \brief Newest images of all DBs of one job.
+struct PlcSnapshot
+{
+    PlcKey key;
+    std::vector<DbSnapshot> dbs;
+    unsigned long seq = 0;
+};
+
+class AcquisitionScheduler
+{
+    private:
+        using clock = std::chrono::steady_clock;
+
+        struct Job
+        {
+            PlcJobConfig cfg;
+            clock::time_point deadline;
+            clock::time_point last_start{};
+            bool removed = false;
+            unsigned long seq = 0;          ///< Snapshot counter, touched only by the running worker.
+            PlcCycleStats stats;
+            TripleBuffer<PlcSnapshot> handoff;
+        };
+
+        struct Ready
+        {
+            clock::time_point deadline;
+            std::shared_ptr<Job> job;
+            bool operator>(const Ready& other) const { return deadline > other.deadline; }
+        };
+
+        ConnectionPool* pool;
+        std::vector<std::thread> workers;
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::map<PlcKey,std::shared_ptr<Job>> jobs;
+        std::priority_queue<Ready,std::vector<Ready>,std::greater<Ready>> ready;
+        bool stop_requested = false;
+
+        void _worker();
+        void _run_job(Job& job,clock::time_point start);
+
+    public:
+        explicit AcquisitionScheduler(ConnectionPool* pool_in,unsigned worker_count = 8);
+        ~AcquisitionScheduler();
+
+        AcquisitionScheduler(const AcquisitionScheduler&) = delete;
+        AcquisitionScheduler& operator=(const AcquisitionScheduler&) = delete;
+
+        void add(const PlcJobConfig& cfg);
+        void remove(const PlcKey& key);
+        void clear();
+
+        size_t size();
+        bool has(const PlcKey& key);
+        std::vector<PlcCycleStats> get_stats();
+        const PlcSnapshot* fetch(const PlcKey& key);
+};
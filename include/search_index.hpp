@@ -0,0 +1,107 @@
+#pragma once
+
+#include <classes.hpp>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+/**
+ * @brief Case-folded substring index over the leaves of one DB.
+ * @details
+ * Built once per DB and cached on it (see of()). capture() runs on the GUI thread and
+ * flattens the tree in document order. UDT arrays are not materialized: every index gets
+ * its nodes from the prototype, with the leaf offsets shifted to the element (values are
+ * read through these records, see capture_values()), and apply() reaches the elements
+ * through the array. build() may then run on any thread. It stores, lowercased and
+ * in one contiguous buffer, every distinct name and comment (pooled strings, so a name
+ * shared by thousands of leaves is stored and searched once) and the full symbol path of
+ * every leaf ("Station_1.Motor.Speed", "Arr[3]"), plus two trigram posting indexes: one
+ * over the distinct strings and one over the paths.
+ *
+ * evaluate() intersects the posting lists of the needle trigrams, starting from the
+ * shortest, and verifies only the remaining candidates; needles shorter than three
+ * characters fall back to a scan of the folded texts. The result is one visibility bit
+ * per node (leaves that match, and their ancestors), which apply() writes to the tree.
+ */
+namespace Filter
+{
+    /// \brief Visibility bitmap, one bit per node of a SearchIndex.
+    using VisBitmap = std::vector<std::uint64_t>;
+
+    /// \brief Bool leaves of a SearchIndex and their values, one bit per leaf.
+    struct BoolPlane
+    {
+        VisBitmap is_bool;
+        VisBitmap value;
+    };
+
+    class SearchIndex
+    {
+        private:
+            /// \brief Folded text inside \c text.
+            struct Span
+            {
+                std::uint32_t offset = 0;
+                std::uint32_t size = 0;
+            };
+
+            /// \brief Trigram -> sorted ids of the spans containing it.
+            struct Postings
+            {
+                std::vector<std::uint32_t> keys;    ///< Sorted trigrams.
+                std::vector<std::uint32_t> starts;  ///< keys.size()+1 offsets into ids.
+                std::vector<std::uint32_t> ids;
+
+                void fill(const std::string& text,const std::vector<Span>& spans);
+                const std::uint32_t* find(std::uint32_t key,std::size_t& count)const;
+                void candidates(std::string_view needle,std::vector<std::uint32_t>& out)const;
+            };
+
+            // Captured on the GUI thread.
+            std::vector<const VariantElement*> elements;    ///< Nodes in document order, nullptr under a UDT array.
+            std::vector<int> parents;                       ///< Parent node, -1 for the roots.
+            std::vector<int> path_parents;                  ///< Node whose path prefixes this one, -1 for none.
+            std::vector<char> arrays;                       ///< Node is an array (see path_parents).
+            std::vector<int> slots;                         ///< Under a UDT array: array index of an element, child index otherwise.
+            std::vector<const std::string*> names;          ///< Pooled name of every node.
+            std::deque<std::string> element_names;          ///< Names of the UDT array elements ("Arr[3]").
+            std::vector<std::uint32_t> leaf_nodes;          ///< Node index of every leaf.
+            std::vector<const std::string*> comments;       ///< Pooled comment of every leaf.
+            std::vector<int> record_of;                     ///< Record of every leaf in records, -1 for a leaf of the tree.
+            std::vector<LeafRecord> records;                ///< Layout of the leaves under UDT arrays.
+
+            // Filled by build().
+            std::once_flag built;
+            std::string text;                               ///< Folded texts, contiguous.
+            std::vector<Span> strings;                      ///< Distinct names and comments.
+            std::vector<std::uint32_t> name_ids;            ///< String of the name of every leaf.
+            std::vector<std::uint32_t> comment_ids;         ///< String of the comment of every leaf.
+            std::vector<Span> paths;                        ///< Symbol path of every leaf.
+            Postings string_grams;
+            Postings path_grams;
+            double build_ms = 0.0;
+
+            int _add_node(const VariantElement* el,int parent,const std::string* name,bool array,int slot);
+            void _capture_array(const UDT_ARRAY& arr,int node,std::uint32_t shift);
+            void _capture_childs(const std::vector<VariantElement>& childs,int parent,std::uint32_t shift);
+            void _build();
+            bool _match_strings(std::string_view needle,std::vector<char>& hits)const;
+            std::string_view _text(Span span)const;
+
+        public:
+            static std::shared_ptr<SearchIndex> capture(const std::shared_ptr<DB>& db);
+            static std::shared_ptr<SearchIndex> of(const std::shared_ptr<DB>& db);
+
+            void build();
+            std::vector<Value> capture_values(const DB& db)const;
+            BoolPlane capture_bools(const DB& db)const;
+            bool evaluate(const filterElem& f,const std::vector<Value>* values,const BoolPlane* bools,
+                          VisBitmap& vis,const std::function<bool()>& cancelled = {})const;
+            void apply(const VisBitmap& vis,const VisBitmap* previous)const;
+
+            std::size_t get_node_count()const;
+            std::size_t get_leaf_count()const;
+            std::size_t get_bytes()const;
+            double get_build_ms()const;
+    };
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <unordered_map>
+#include <deque>
+#include <mutex>
+#include <array>
+
+/**
+ * @brief Pool of the element names, types and comments of a project.
+ * @details
+ * A type name such as "Int" or "\"MyUdt\"" is shared by thousands of nodes; each node
+ * stores a PooledString (one pointer) instead of its own std::string, and the accessors
+ * return a const reference into the pool, so reading a name never copies.
+ *
+ * The pool is owned by the DbCatalog of the project and reached through the ElementArena
+ * the nodes are built in (see arena.hpp): a PooledString made while an arena::Scope is
+ * active interns into the pool of that arena. Every arena holds a reference to its pool,
+ * so a name stays valid as long as a node of a DB using the pool is alive; the pool is
+ * freed once the project is closed or re-indexed and its last DB is released.
+ * Handles made outside any arena go to string_pool::constants(); static constants are
+ * built there explicitly (PooledString(pool, s)), whatever arena is current on first use.
+ *
+ * Strings are not removed from a live pool. The pool is split into shards, each with its
+ * own mutex, so the indexing threads rarely wait on each other.
+ */
+
+/// \brief Counters of the pool.
+struct StringPoolStats
+{
+    std::size_t strings = 0;    ///< Distinct strings stored.
+    std::size_t bytes = 0;      ///< Characters stored.
+    std::size_t hits = 0;       ///< intern() calls answered by an existing string.
+};
+
+class StringPool
+{
+    private:
+        static constexpr std::size_t shard_count = 16;
+
+        struct Shard
+        {
+            std::mutex mtx;
+            std::deque<std::string> storage;
+            std::unordered_map<std::string_view,const std::string*> index;
+            std::size_t bytes = 0;
+            std::size_t hits = 0;
+        };
+
+        std::array<Shard,shard_count> shards;
+
+    public:
+        StringPool() = default;
+        StringPool(const StringPool&) = delete;
+        StringPool& operator=(const StringPool&) = delete;
+
+        const std::string& intern(std::string_view s);
+        StringPoolStats get_stats();
+};
+
+/// \brief Handle to a pooled string: one pointer, equal strings of one pool share it.
+class PooledString
+{
+    private:
+        const std::string* str;
+
+    public:
+        PooledString();
+        PooledString(std::string_view s);
+        PooledString(const std::string& s) : PooledString(std::string_view(s)) {}
+        PooledString(const char* s) : PooledString(std::string_view(s)) {}
+        PooledString(StringPool& pool,std::string_view s) : str(&pool.intern(s)) {}
+
+        const std::string& get() const { return *str; }
+        operator const std::string&() const { return *str; }
+
+        bool operator==(const PooledString& other) const { return str == other.str || *str == *other.str; }
+        bool operator!=(const PooledString& other) const { return !(*this == other); }
+};
+
+inline std::ostream& operator<<(std::ostream& os,const PooledString& s){return os << s.get();}
+
+namespace string_pool
+{
+    /// \brief Pool of the handles made outside any arena (static constants).
+    StringPool& constants();
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <datatype.hpp>
+#include <read_planner.hpp>
+
+/**
+ * @brief Registry of the DB elements that views currently need.
+ * @details
+ * Views (the tree viewer, the filter, watch lists, exporters, ...) register interest
+ * in subtrees or single leaves under their own name. The registry keeps the union of
+ * all subscribed leaves and the merged byte ranges covering them; the acquisition path
+ * reads only those ranges and decodes only those leaves.
+ *
+ * The union is rebuilt lazily after a change; get_version() increases every time the
+ * union changes, so callers can cheaply detect when to re-plan.
+ */
+class SubscriptionRegistry
+{
+    private:
+        std::map<std::string,std::vector<VariantElement>> interests;
+        std::vector<BASE*> leaves;
+        SharedRanges ranges = std::make_shared<const std::vector<ByteRange>>();
+        int merge_gap = read_planner::default_merge_gap;
+        unsigned long version = 0;
+        unsigned long generation = 0;       ///< class_utils::tree_generation() of the last rebuild.
+        bool dirty = false;
+
+        void _rebuild();
+
+    public:
+        SubscriptionRegistry() = default;
+
+        void subscribe(const std::string& view,const VariantElement& el);
+        void set(const std::string& view,const std::vector<VariantElement>& els);
+        void unsubscribe(const std::string& view);
+        void clear();
+        void set_merge_gap(int gap);
+
+        bool empty()const;
+        bool has(const std::string& view)const;
+        unsigned long get_version();
+        const std::vector<BASE*>& get_leaves();
+        SharedRanges get_ranges();
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <classes.hpp>
+
+/**
+ * @brief Depth-first traversal of an element tree without recursion or allocation.
+ * @details
+ * The walk keeps one frame per open container (its child list and the next index) on a
+ * per-thread stack that keeps its capacity from one walk to the next, so after the first
+ * walk no heap allocation happens. Children are visited through const references to the
+ * containers' own child lists: no vector is copied and no shared_ptr count is touched.
+ *
+ * enter(el) is called for every element in document order; if it returns true and \p el
+ * is a container, its children are walked, then leave(el) is called. enter/leave may
+ * start another walk (the stack is shared but each walk only pops its own frames); they
+ * must not add or remove children of a container whose children are being walked.
+ */
+namespace tree_walk
+{
+    struct Frame
+    {
+        const VariantElement* childs;
+        std::size_t count;
+        std::size_t next;
+        const VariantElement* owner;        ///< Container the childs belong to, nullptr for the roots.
+    };
+
+    /// \brief Frames of the walks running on this thread.
+    inline thread_local std::vector<Frame> frames;
+
+    /// \brief Children of \p el, nullptr for a leaf.
+    inline const std::vector<VariantElement>* childs_of(const VariantElement& el)
+    {
+        return std::visit([](const auto& ptr) -> const std::vector<VariantElement>* {
+            using T = std::decay_t<decltype(*ptr)>;
+            if constexpr (std::is_base_of_v<BASE_CONTAINER, T>) return &ptr->get_childs();
+            else return nullptr;
+        }, el);
+    }
+
+    /// \brief Walks the \p count elements from \p roots and their descendants, see above.
+    template<class Enter,class Leave>
+    void walk(const VariantElement* roots,std::size_t count,Enter&& enter,Leave&& leave)
+    {
+        const std::size_t base = frames.size();
+        frames.push_back({roots, count, 0, nullptr});
+
+        try {
+            while (frames.size() > base) {
+                Frame& top = frames.back();
+                if (top.next == top.count) {
+                    const VariantElement* owner = top.owner;
+                    frames.pop_back();
+                    if (owner != nullptr) leave(*owner);
+                    continue;
+                }
+
+                const VariantElement& el = top.childs[top.next++];
+                if (!enter(el)) continue;
+                if (const auto* childs = childs_of(el)) frames.push_back({childs->data(), childs->size(), 0, &el});
+            }
+        }
+        catch (...) {
+            frames.resize(base);
+            throw;
+        }
+    }
+
+    template<class Enter,class Leave>
+    void walk(const std::vector<VariantElement>& roots,Enter&& enter,Leave&& leave)
+    {
+        walk(roots.data(), roots.size(), std::forward<Enter>(enter), std::forward<Leave>(leave));
+    }
+
+    /// \brief Walks without a leave callback.
+    template<class Enter>
+    void walk(const std::vector<VariantElement>& roots,Enter&& enter)
+    {
+        walk(roots.data(), roots.size(), std::forward<Enter>(enter), [](const VariantElement&) {});
+    }
+};
@@ -0,0 +1,421 @@
+#pragma once
+
+#include <datatype.hpp>
+#include <cstdio>
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
+
+/**
+ * @brief Compile-time decoders for TIA basic types.
+ * @details
+ * Type names are resolved once (when an element is created by the parser) into a TiaType.
+ * From there on sizes come from a constexpr table indexed by the code and decoding goes
+ * through Reader<T>, one specialization per type with a constexpr size. read() dispatches
+ * through a table of Reader<T>::read pointers built at compile time, so the decode path
+ * has no string compare, no hashing and no branch on type names.
+ *
+ * All multi-byte values are big endian (S7 byte order): a value is loaded with one
+ * memcpy and one byte swap instruction. Fixed-size numeric and time types also expose
+ * their raw big-endian integer (Reader<T>::raw) and the conversion from it (make), which
+ * read_array() uses to decode a run of array elements: the whole run is copied and
+ * byte-swapped in one loop the compiler vectorizes, then converted element by element.
+ */
+namespace tia
+{
+    /// \brief Name and size ({bytes,bits}) of a TIA basic type.
+    struct TypeInfo
+    {
+        const char* name;
+        int bytes;
+        int bits;
+    };
+
+    constexpr std::size_t type_count = static_cast<std::size_t>(TiaType::Unknown);
+
+    /// \brief Indexed by TiaType, same order as the enum.
+    constexpr std::array<TypeInfo,type_count> type_info = {{
+        {"bool",            0, 1},
+        {"byte",            1, 0},
+        {"char",            1, 0},
+        {"word",            2, 0},
+        {"int",             2, 0},
+        {"dint",            4, 0},
+        {"real",            4, 0},
+        {"string",        256, 0},
+        {"date",            2, 0},
+        {"dword",           4, 0},
+        {"lreal",           8, 0},
+        {"sint",            1, 0},
+        {"time",            4, 0},
+        {"udint",           4, 0},
+        {"uint",            2, 0},
+        {"usint",           1, 0},
+        {"date_and_time",   8, 0},
+        {"dtl",            12, 0},
+        {"lint",            8, 0},
+        {"ulint",           8, 0},
+        {"lword",           8, 0},
+        {"ltime",           8, 0},
+        {"time_of_day",     4, 0},
+    }};
+
+    /// \brief {bytes,bits} of \p t, {0,0} for TiaType::Unknown.
+    constexpr std::pair<int,int> size_of(TiaType t)
+    {
+        return t == TiaType::Unknown ? std::pair<int,int>{0,0}
+            : std::pair<int,int>{type_info[static_cast<std::size_t>(t)].bytes, type_info[static_cast<std::size_t>(t)].bits};
+    }
+
+    /// \brief Resolves a type name (case-insensitive, no allocation); TiaType::Unknown if not basic.
+    inline TiaType code_of(std::string_view name)
+    {
+        auto same = [](std::string_view ref, std::string_view n) {
+            return ref.size() == n.size() &&
+                std::equal(ref.begin(), ref.end(), n.begin(),
+                    [](char a, char b) { return a == std::tolower(static_cast<unsigned char>(b)); });
+        };
+        for (std::size_t i = 0; i < type_count; ++i)
+            if (same(type_info[i].name, name)) return static_cast<TiaType>(i);
+        if (same("tod", name)) return TiaType::TimeOfDay;
+        if (same("dt", name)) return TiaType::DateAndTime;
+        return TiaType::Unknown;
+    }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    constexpr bool host_big_endian = true;
+#else
+    constexpr bool host_big_endian = false;     ///< x86, ARM and every MSVC target.
+#endif
+
+    /// \brief Reverses the byte order of \p v (a single instruction on every target).
+    inline std::uint8_t bswap(std::uint8_t v) { return v; }
+#if defined(_MSC_VER)
+    inline std::uint16_t bswap(std::uint16_t v) { return _byteswap_ushort(v); }
+    inline std::uint32_t bswap(std::uint32_t v) { return _byteswap_ulong(v); }
+    inline std::uint64_t bswap(std::uint64_t v) { return _byteswap_uint64(v); }
+#else
+    inline std::uint16_t bswap(std::uint16_t v) { return __builtin_bswap16(v); }
+    inline std::uint32_t bswap(std::uint32_t v) { return __builtin_bswap32(v); }
+    inline std::uint64_t bswap(std::uint64_t v) { return __builtin_bswap64(v); }
+#endif
+
+    /// \brief Loads a big-endian unsigned integer of type \p U.
+    template<typename U>
+    inline U load_be(const unsigned char* p)
+    {
+        U v;
+        std::memcpy(&v, p, sizeof(U));
+        if constexpr (!host_big_endian) v = bswap(v);
+        return v;
+    }
+
+    /// \brief Loads \p count consecutive big-endian integers of type \p U.
+    /// \details No dependency between the elements: GCC, Clang and MSVC turn the swap loop
+    /// into vector shuffles.
+    template<typename U>
+    inline void load_be_array(const unsigned char* p,std::size_t count,U* out)
+    {
+        std::memcpy(out, p, count * sizeof(U));
+        if constexpr (!host_big_endian && sizeof(U) > 1)
+            for (std::size_t i = 0; i < count; ++i) out[i] = bswap(out[i]);
+    }
+
+    /// \brief Reads \p count (at most 57) bits starting at bit \p first of \p p, into the low
+    /// bits of the result.
+    /// \details S7 numbers the bits of a byte from the LSB and packs Bool runs (arrays, bit
+    /// structs) into consecutive bits, so a little-endian load turns a run into consecutive
+    /// bits of one word: 57 Bools come out of one unaligned load and a shift.
+    /// \param size Bytes available at \p p; never read past them.
+    inline std::uint64_t load_bits(const unsigned char* p,std::size_t size,std::size_t first,std::size_t count)
+    {
+        const std::size_t byte = first / 8;
+        const std::size_t bytes = std::min<std::size_t>(8, size - byte);
+        std::uint64_t v = 0;
+        if (bytes == 8) std::memcpy(&v, p + byte, 8);
+        else std::memcpy(&v, p + byte, bytes);
+        if constexpr (host_big_endian) v = bswap(v);
+        v >>= first % 8;
+        return count >= 64 ? v : v & ((std::uint64_t(1) << count) - 1);
+    }
+
+    /// \brief Two BCD digits to their value.
+    constexpr int from_bcd(unsigned char b) { return (b >> 4) * 10 + (b & 0x0F); }
+
+    constexpr std::int64_t ns_per_ms = 1000000;
+    constexpr std::int64_t ns_per_s = 1000000000;
+    constexpr std::int64_t ns_per_day = 86400 * ns_per_s;
+    constexpr std::int64_t days_1970_to_1990 = 7305;    ///< DATE counts days from 1990-01-01.
+
+    /// \brief Days since 1970-01-01 of a proleptic Gregorian date.
+    constexpr std::int64_t days_from_civil(int y,unsigned m,unsigned d)
+    {
+        y -= m <= 2;
+        const int era = (y >= 0 ? y : y - 399) / 400;
+        const unsigned yoe = static_cast<unsigned>(y - era * 400);
+        const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+        const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return static_cast<std::int64_t>(era) * 146097 + static_cast<std::int64_t>(doe) - 719468;
+    }
+
+    /// \brief Date {year,month,day} of a day count since 1970-01-01.
+    constexpr std::array<int,3> civil_from_days(std::int64_t z)
+    {
+        z += 719468;
+        const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const unsigned doe = static_cast<unsigned>(z - era * 146097);
+        const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const unsigned mp = (5 * doy + 2) / 153;
+        const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+        const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+        return {static_cast<int>(yoe + era * 400 + (m <= 2)), static_cast<int>(m), static_cast<int>(d)};
+    }
+
+    /// \brief Decoder of one TIA type; \c bytes is its constexpr size.
+    /// read(p, bit, len): \p p points at the first byte, \p bit is used by Bool only,
+    /// \p len by String only.
+    template<TiaType T> struct Reader;
+
+    /// \brief Fixed-size integer types, sign-extended when the TIA type is signed.
+    /// \tparam Int TIA integer type, \tparam Out Value alternative it is stored as.
+    template<typename Int,typename Out>
+    struct IntReader
+    {
+        using raw = std::make_unsigned_t<Int>;
+        static constexpr int bytes = sizeof(Int);
+        static Value make(raw v) { return static_cast<Out>(static_cast<Int>(v)); }
+        static Value read(const unsigned char* p,int,int) { return make(load_be<raw>(p)); }
+    };
+
+    /// \brief IEEE 754 single/double precision.
+    template<typename Float,typename Raw>
+    struct FloatReader
+    {
+        static_assert(sizeof(Float) == sizeof(Raw), "Float and Raw differ in size");
+        using raw = Raw;
+        static constexpr int bytes = sizeof(Raw);
+        static Value make(raw v) { Float f; std::memcpy(&f, &v, sizeof(f)); return f; }
+        static Value read(const unsigned char* p,int,int) { return make(load_be<raw>(p)); }
+    };
+
+    /// \brief Time types stored as an integer count: ns = count * Scale + Bias.
+    template<typename Int,std::int64_t Scale,std::int64_t Bias,TimeValue::Kind K>
+    struct TimeReader
+    {
+        using raw = std::make_unsigned_t<Int>;
+        static constexpr int bytes = sizeof(Int);
+        static Value make(raw v) { return TimeValue{static_cast<std::int64_t>(static_cast<Int>(v)) * Scale + Bias, K}; }
+        static Value read(const unsigned char* p,int,int) { return make(load_be<raw>(p)); }
+    };
+
+    template<> struct Reader<TiaType::Byte>  : IntReader<std::uint8_t,  int>           {};
+    template<> struct Reader<TiaType::USInt> : IntReader<std::uint8_t,  int>           {};
+    template<> struct Reader<TiaType::SInt>  : IntReader<std::int8_t,   int>           {};
+    template<> struct Reader<TiaType::Word>  : IntReader<std::uint16_t, int>           {};
+    template<> struct Reader<TiaType::UInt>  : IntReader<std::uint16_t, int>           {};
+    template<> struct Reader<TiaType::Int>   : IntReader<std::int16_t,  int>           {};
+    template<> struct Reader<TiaType::DWord> : IntReader<std::uint32_t, std::uint64_t> {};
+    template<> struct Reader<TiaType::UDInt> : IntReader<std::uint32_t, std::uint64_t> {};
+    template<> struct Reader<TiaType::DInt>  : IntReader<std::int32_t,  int>           {};
+    template<> struct Reader<TiaType::LWord> : IntReader<std::uint64_t, std::uint64_t> {};
+    template<> struct Reader<TiaType::ULInt> : IntReader<std::uint64_t, std::uint64_t> {};
+    template<> struct Reader<TiaType::LInt>  : IntReader<std::int64_t,  std::int64_t>  {};
+
+    template<> struct Reader<TiaType::Real>  : FloatReader<float,  std::uint32_t> {};
+    template<> struct Reader<TiaType::LReal> : FloatReader<double, std::uint64_t> {};
+
+    /// \brief TIME: signed milliseconds; LTIME: signed nanoseconds.
+    template<> struct Reader<TiaType::Time>  : TimeReader<std::int32_t, ns_per_ms, 0, TimeValue::Kind::Duration> {};
+    template<> struct Reader<TiaType::LTime> : TimeReader<std::int64_t, 1, 0, TimeValue::Kind::Duration> {};
+    /// \brief DATE: days since 1990-01-01.
+    template<> struct Reader<TiaType::Date>  : TimeReader<std::uint16_t, ns_per_day, days_1970_to_1990 * ns_per_day, TimeValue::Kind::Date> {};
+    /// \brief TIME_OF_DAY: milliseconds since midnight.
+    template<> struct Reader<TiaType::TimeOfDay> : TimeReader<std::uint32_t, ns_per_ms, 0, TimeValue::Kind::TimeOfDay> {};
+
+    template<> struct Reader<TiaType::Bool>
+    {
+        static constexpr int bytes = 0;
+        static Value read(const unsigned char* p,int bit,int) { return ((*p >> bit) & 0x01) != 0; }
+    };
+
+    template<> struct Reader<TiaType::Char>
+    {
+        static constexpr int bytes = 1;
+        static Value read(const unsigned char* p,int,int) { return std::string(1, static_cast<char>(*p)); }
+    };
+
+    template<> struct Reader<TiaType::String>
+    {
+        static constexpr int bytes = 256;
+        static Value read(const unsigned char* p,int,int len)
+        {
+            return std::string(reinterpret_cast<const char*>(p), static_cast<std::size_t>(len));
+        }
+    };
+
+    /// \brief DATE_AND_TIME: BCD year/month/day/hour/minute/second, 3 BCD digits of ms, weekday.
+    template<> struct Reader<TiaType::DateAndTime>
+    {
+        static constexpr int bytes = 8;
+        static Value read(const unsigned char* p,int,int)
+        {
+            int year = from_bcd(p[0]);
+            year += year < 90 ? 2000 : 1900;
+            const std::int64_t days = days_from_civil(year, static_cast<unsigned>(from_bcd(p[1])), static_cast<unsigned>(from_bcd(p[2])));
+            const std::int64_t secs = from_bcd(p[3]) * 3600 + from_bcd(p[4]) * 60 + from_bcd(p[5]);
+            const std::int64_t ms = from_bcd(p[6]) * 10 + (p[7] >> 4);
+            return TimeValue{days * ns_per_day + secs * ns_per_s + ms * ns_per_ms, TimeValue::Kind::DateTime};
+        }
+    };
+
+    /// \brief DTL: UInt year, USInt month/day/weekday/hour/minute/second, UDInt nanoseconds.
+    template<> struct Reader<TiaType::DTL>
+    {
+        static constexpr int bytes = 12;
+        static Value read(const unsigned char* p,int,int)
+        {
+            const std::int64_t days = days_from_civil(load_be<std::uint16_t>(p), p[2], p[3]);
+            const std::int64_t secs = p[5] * 3600 + p[6] * 60 + p[7];
+            return TimeValue{days * ns_per_day + secs * ns_per_s + load_be<std::uint32_t>(p + 8), TimeValue::Kind::DateTime};
+        }
+    };
+
+    using ReadFn = Value(*)(const unsigned char*,int,int);
+
+    template<std::size_t... I>
+    constexpr std::array<ReadFn,sizeof...(I)> make_readers(std::index_sequence<I...>)
+    {
+        return {{ &Reader<static_cast<TiaType>(I)>::read... }};
+    }
+
+    /// \brief Reader<T>::read for every TiaType, indexed by the code.
+    constexpr std::array<ReadFn,type_count> readers = make_readers(std::make_index_sequence<type_count>{});
+
+    template<std::size_t... I>
+    constexpr bool sizes_match(std::index_sequence<I...>)
+    {
+        return ((Reader<static_cast<TiaType>(I)>::bytes == type_info[I].bytes) && ...);
+    }
+    static_assert(sizes_match(std::make_index_sequence<type_count>{}), "Reader sizes out of sync with type_info");
+
+    /// \brief Decodes a value of type \p t at \p p; 0 for TiaType::Unknown.
+    inline Value read(TiaType t,const unsigned char* p,int bit,int len)
+    {
+        if (t == TiaType::Unknown) return 0;
+        return readers[static_cast<std::size_t>(t)](p, bit, len);
+    }
+
+    template<typename R,typename = void> struct has_raw : std::false_type {};
+    template<typename R> struct has_raw<R,std::void_t<typename R::raw>> : std::true_type {};
+
+    /// \brief Decodes \p count back-to-back values of type \p T, in chunks that stay on the stack.
+    template<TiaType T>
+    void read_array_of(const unsigned char* p,std::size_t count,Value* out)
+    {
+        using R = Reader<T>;
+        constexpr std::size_t chunk = 256;
+        typename R::raw raw[chunk];
+
+        for (std::size_t done = 0; done < count; ) {
+            const std::size_t n = std::min(chunk, count - done);
+            load_be_array(p + done * sizeof(raw[0]), n, raw);
+            for (std::size_t i = 0; i < n; ++i) out[done + i] = R::make(raw[i]);
+            done += n;
+        }
+    }
+
+    using ReadArrayFn = void(*)(const unsigned char*,std::size_t,Value*);
+
+    template<TiaType T>
+    constexpr ReadArrayFn array_reader()
+    {
+        if constexpr (has_raw<Reader<T>>::value) return &read_array_of<T>;
+        else return nullptr;
+    }
+
+    template<std::size_t... I>
+    constexpr std::array<ReadArrayFn,sizeof...(I)> make_array_readers(std::index_sequence<I...>)
+    {
+        return {{ array_reader<static_cast<TiaType>(I)>()... }};
+    }
+
+    /// \brief read_array_of<T> for the fixed-size numeric and time types, nullptr for the others.
+    constexpr std::array<ReadArrayFn,type_count> array_readers = make_array_readers(std::make_index_sequence<type_count>{});
+
+    /// \brief True if runs of \p t can be decoded with read_array().
+    inline bool has_array_reader(TiaType t)
+    {
+        return t != TiaType::Unknown && array_readers[static_cast<std::size_t>(t)] != nullptr;
+    }
+
+    /// \brief Decodes \p count values of type \p t stored back to back at \p p.
+    /// \pre has_array_reader(t).
+    inline void read_array(TiaType t,const unsigned char* p,std::size_t count,Value* out)
+    {
+        array_readers[static_cast<std::size_t>(t)](p, count, out);
+    }
+
+    /// \brief TIA literal of a time or date ("T#1d_2h_3ms", "D#2024-05-01", "TOD#08:30:00.000",
+    /// "DT#2024-05-01-08:30:00.000").
+    inline std::string to_string(const TimeValue& t)
+    {
+        char out[64];
+        if (t.kind == TimeValue::Kind::Duration) {
+            std::string s = t.ns < 0 ? "T#-" : "T#";
+            std::uint64_t rest = t.ns < 0 ? 0 - static_cast<std::uint64_t>(t.ns) : static_cast<std::uint64_t>(t.ns);
+            static constexpr std::pair<std::uint64_t,const char*> units[] = {
+                {86400ull * 1000000000ull, "d"}, {3600ull * 1000000000ull, "h"}, {60ull * 1000000000ull, "m"},
+                {1000000000ull, "s"}, {1000000ull, "ms"}, {1000ull, "us"}, {1ull, "ns"}};
+            bool first = true;
+            for (const auto& [scale, unit] : units) {
+                const std::uint64_t n = rest / scale;
+                rest %= scale;
+                if (n == 0) continue;
+                std::snprintf(out, sizeof(out), "%s%llu%s", first ? "" : "_", static_cast<unsigned long long>(n), unit);
+                s += out;
+                first = false;
+            }
+            return first ? s + "0ms" : s;
+        }
+
+        const std::int64_t days = t.ns >= 0 ? t.ns / ns_per_day : (t.ns - ns_per_day + 1) / ns_per_day;
+        const std::int64_t in_day = t.ns - days * ns_per_day;
+        const auto [y, m, d] = civil_from_days(days);
+        const int hh = static_cast<int>(in_day / (3600 * ns_per_s));
+        const int mm = static_cast<int>(in_day / (60 * ns_per_s) % 60);
+        const int ss = static_cast<int>(in_day / ns_per_s % 60);
+        const long sub = static_cast<long>(in_day % ns_per_s);
+
+        switch (t.kind) {
+            case TimeValue::Kind::Date:
+                std::snprintf(out, sizeof(out), "D#%04d-%02d-%02d", y, m, d);
+                break;
+            case TimeValue::Kind::TimeOfDay:
+                std::snprintf(out, sizeof(out), "TOD#%02d:%02d:%02d.%03ld", hh, mm, ss, sub / ns_per_ms);
+                break;
+            default:
+                if (sub % ns_per_ms != 0)
+                    std::snprintf(out, sizeof(out), "DT#%04d-%02d-%02d-%02d:%02d:%02d.%09ld", y, m, d, hh, mm, ss, sub);
+                else
+                    std::snprintf(out, sizeof(out), "DT#%04d-%02d-%02d-%02d:%02d:%02d.%03ld", y, m, d, hh, mm, ss, sub / ns_per_ms);
+                break;
+        }
+        return out;
+    }
+
+    /// \brief Any decoded value as text, numbers in full precision.
+    inline std::string to_string(const Value& v)
+    {
+        return std::visit(overloaded{
+            [](int x)                 { return std::to_string(x); },
+            [](bool x)                { return std::string(x ? "true" : "false"); },
+            [](const std::string& x)  { return x; },
+            [](std::int64_t x)        { return std::to_string(x); },
+            [](std::uint64_t x)       { return std::to_string(x); },
+            [](float x)               { char b[32]; std::snprintf(b, sizeof(b), "%.9g", x); return std::string(b); },
+            [](double x)              { char b[32]; std::snprintf(b, sizeof(b), "%.17g", x); return std::string(b); },
+            [](const TimeValue& x)    { return to_string(x); },
+        }, v);
+    }
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <datatype.hpp>
+#include <string_pool.hpp>
+#include <mutex>
+
+/**
+ * @brief Project-wide registry of parsed UDT definitions.
+ * @details
+ * Every .db export repeats the `TYPE ... END_TYPE` blocks of the UDTs it uses, so the same
+ * UDT is found in many files of a project. A file is cut into its UDT blocks and its DB
+ * section (udt_library::split); each block is keyed by its name and the FNV-1a hash of its
+ * text, mixed with the keys of the UDTs it references (the parser copies nested definitions
+ * into the outer one, so they are part of its content). A block already in the library is
+ * not parsed again: the shared UDT_RAW is put in the ParserState registry and only the
+ * unknown blocks and the DB section go through the grammar. A name with different content
+ * in two files gives two entries, each file keeps the definition it exports.
+ *
+ * UDT_RAW trees are templates: DBs get deep copies (UDT_SINGLE::create_from_element), so
+ * one instance can be shared by all DBs and all parser threads. They are built in an arena
+ * of their file on the project string pool, like the DBs copied from them.
+ */
+
+/// \brief Counters of the library, reuse figures are what the parser did not have to do.
+struct UdtLibraryStats
+{
+    std::size_t unique = 0;         ///< Distinct definitions parsed.
+    std::size_t reused = 0;         ///< Blocks taken from the library instead of parsed.
+    double parse_ms = 0.0;          ///< Time spent parsing the unique definitions.
+    double saved_ms = 0.0;          ///< Parse time of the reused blocks.
+    std::size_t saved_bytes = 0;    ///< Approximate memory of the UDT trees not duplicated.
+};
+
+class UdtLibrary
+{
+    private:
+        struct Entry
+        {
+            std::shared_ptr<UDT_RAW> udt;
+            double parse_ms;
+            std::size_t bytes;
+        };
+
+        mutable std::mutex mtx;
+        std::map<std::pair<std::string,std::uint64_t>,Entry> entries;
+        UdtLibraryStats stats;
+
+    public:
+        std::shared_ptr<UDT_RAW> find(const std::string& name,std::uint64_t hash);
+        std::shared_ptr<UDT_RAW> insert(const std::string& name,std::uint64_t hash,std::shared_ptr<UDT_RAW> udt,double parse_ms);
+
+        UdtLibraryStats get_stats()const;
+        void clear();
+};
+
+namespace udt_library
+{
+    /// \brief One UDT block of a source file.
+    struct UdtBlock
+    {
+        std::string name;           ///< As written after TYPE, quotes included.
+        std::string_view text;      ///< From `TYPE` up to the next block.
+    };
+
+    /// \brief A source file cut into UDT blocks (in file order) and DB section.
+    struct SourceSplit
+    {
+        std::vector<UdtBlock> udts;
+        std::string_view db;
+    };
+
+    bool split(std::string_view text,SourceSplit& out);
+
+    std::size_t tree_bytes(const UDT_RAW& udt);
+
+    std::shared_ptr<DB> parse(const std::string& path,const std::string& name,UdtLibrary& library,UdtRawMap& udts,std::shared_ptr<StringPool> strings);
+};
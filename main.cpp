@@ -2,6 +2,9 @@
 #include <gui.hpp>
 #include <GLFW/glfw3.h>
 #include <type_traits>
+#include <optional>
+#include <cerrno>
+#include <cstdlib>
 #include <datatype.hpp>
 
 namespace fs = std::filesystem;
@@ -49,7 +52,32 @@ void SetModernStyle()
     ImGui::PushFont(myFont);
 }
 
-int main() {
+/// \brief Positive decimal count in \p arg (whole string), nullopt otherwise.
+static std::optional<long> parse_count(const char* arg)
+{
+    char* end = nullptr;
+    errno = 0;
+    const long n = std::strtol(arg, &end, 10);
+    if (end == arg || *end != '\0' || errno == ERANGE || n < 1) return std::nullopt;
+    return n;
+}
+
+int main(int argc, char** argv) {
+    // --bench-dcp <capture.pcap> [n]: DCP parser throughput on saved replies, no window;
+    //   fails unless the replay lists exactly n devices (when given) and drops none.
+    // --gen-dcp <out.pcap> [n]: writes Identify responses of n synthetic PLCs, no window.
+    // --replay-dcp <capture.pcap>: discovery reads the file instead of the network card.
+    const std::string mode = argc >= 3 ? argv[1] : "";
+    if (mode == "--bench-dcp" || mode == "--gen-dcp") {
+        std::optional<long> count = argc >= 4 ? parse_count(argv[3]) : std::nullopt;
+        if (argc >= 4 && (!count.has_value() || count.value() > profinet::max_fleet)) {
+            std::cerr << "Invalid device count '" << argv[3] << "': expected 1.." << profinet::max_fleet << "\n";
+            return 1;
+        }
+        if (mode == "--bench-dcp") return profinet::bench_parser(argv[2], count.value_or(-1));
+        return profinet::write_fleet(argv[2], static_cast<int>(count.value_or(10000)));
+    }
+
     if (!glfwInit()) return -1;
     GLFWwindow* window = glfwCreateWindow(1280, 720, "PLC-Reader", NULL, NULL);
     glfwMakeContextCurrent(window);
@@ -65,6 +93,7 @@ int main() {
     ImGui_ImplOpenGL3_Init("#version 130");
     
     MainGUIController main;
+    if (mode == "--replay-dcp") main.CommMan->NetMan.replay_capture(argv[2]);
 
     while (!glfwWindowShouldClose(window)) {
 
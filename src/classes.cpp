@@ -1,4 +1,10 @@
 #include <classes.hpp>
+#include <tree_walk.hpp>
+#include <search_index.hpp>
+#include <type_readers.hpp>
+#include <atomic>
+#include <cctype>
+#include <limits>
 
 /// \brief Converts a string to lowercase in-place and returns it.
 /// \param s Input string (copied by value).
@@ -9,120 +15,67 @@ std::string to_lowercase(std::string s)
     [](unsigned char c) { return std::tolower(c); });
     return s;
 };
-std::string_view to_lowercase_view(std::string s)
-{
-    std::transform(s.begin(), s.end(), s.begin(),
-    [](unsigned char c) { return std::tolower(c); });
-    return s;
-};
-/// \brief TIA type size lookup table: {byteCount, bitCount}.
-/// \details Maps TIA basic types to byte/bit sizes used for offset calculations.
-/// Example: {"bool",{0,1}}, {"int",{2,0}}, {"real",{4,0}}, {"string",{256,0}}.
-const std::unordered_map<std::string,std::pair<int,int>> tia_type_size {
-    {"bool",   {  0, 1}},  
-    {"byte",   {  1, 0}}, 
-    {"char",   {  1, 0}},
-    {"word",   {  2, 0}}, 
-    {"int",    {  2, 0}},
-    {"dint",   {  4, 0}}, 
-    {"real",   {  4, 0}},
-    {"string", {256, 0}},
-    {"date",   {  2, 0}},
-    {"dword",  {  4, 0}},
-    {"lreal",  {  8, 0}},
-    {"sint",   {  1, 0}},
-    {"time",   {  4, 0}},
-    {"udint",  {  4, 0}},
-    {"uint",  {  2, 0}},
-    {"usint",  {  1, 0}},
-    {"date_and_time",  {  8, 0}}
-};
-
-/// \brief Recursively sets visibility based on a predicate over BASE nodes.
-/// \tparam Pred Callable with signature \c bool(BASE&).
-/// \param el Variant element (BASE or BASE_CONTAINER).
+/// \brief Sets visibility of \p roots and their descendants based on a predicate over BASE nodes.
+/// \tparam Pred Callable with signature \c bool(BASE&,filterElem*).
+/// \param roots Variant elements (BASE or BASE_CONTAINER).
 /// \param pred Predicate evaluated on leaves; containers are visible if any child matches.
-/// \return true if the element (or any of its descendants) matches.
+/// \details Non-recursive (tree_walk), a container is settled once all its children are.
 template <class Pred>
-bool Filter::walk_set_vis(VariantElement el, filterElem* f, Pred pred) {
-    return std::visit([&](auto& ptr) -> bool {
-        using T = std::decay_t<decltype(ptr)>;
-        using E = typename T::element_type;
-
-        if constexpr (std::is_base_of_v<BASE, E>) 
-        {
-            bool match = pred(*ptr,f);
-            ptr->set_vis(match);
-            
-            return match;
-        } 
-        else if constexpr (std::is_base_of_v<BASE_CONTAINER, E>) 
-        {
-            bool any = false;
-            for (auto& ch : ptr->get_childs())
-                any |= walk_set_vis(ch,f, pred);
-            ptr->set_vis(any);
-            return any;
-        } 
-        else
-        {
-            static_assert(!sizeof(E*), "Type exception in filter");
-        }
-    }, el);
-}
-
-
-static inline bool contains(std::string_view haystack, std::string_view needle) {
-    return !needle.empty() && haystack.find(needle) != std::string_view::npos;
+void Filter::walk_set_vis(const std::vector<VariantElement>& roots, filterElem* f, Pred pred) {
+    tree_walk::walk(roots,
+        [&](const VariantElement& el) {
+            std::visit([&](const auto& ptr) {
+                using E = std::decay_t<decltype(*ptr)>;
+                if constexpr (std::is_base_of_v<BASE, E>)
+                    ptr->set_vis(pred(*ptr,f));
+            }, el);
+            return true;
+        },
+        [](const VariantElement& el) {
+            std::visit([](const auto& ptr) {
+                using E = std::decay_t<decltype(*ptr)>;
+                if constexpr (std::is_base_of_v<BASE_CONTAINER, E>) {
+                    bool any = false;
+                    // Elements that were never materialized are not judged: the array stays shown.
+                    if constexpr (std::is_same_v<E, UDT_ARRAY>) {
+                        ptr->show_all_elements();
+                        any = static_cast<int>(ptr->get_childs().size()) < ptr->get_count();
+                    }
+                    for (const auto& ch : ptr->get_childs())
+                        any = any || std::visit([](const auto& c) { return c->get_vis(); }, ch);
+                    ptr->set_vis(any);
+                }
+            }, el);
+        });
 }
 
-static inline bool variant_matches(const Value& lhs,
-                                   const Value& rhs)
-{
-    return std::visit(overloaded{
-        [](const std::string& a, const std::string& b) 
-        { return contains(to_lowercase_view(a),to_lowercase_view(b)); },
-
-        [](bool a, bool b) { return a  &&  b; },
-
-        [](int a, int b)   { return a == b; },
-
-        [](auto const&, auto const&) {return false; }
-    }, lhs, rhs);
-}
 
 Filter::FilterDB::FilterDB(std::shared_ptr<DB> el) 
     : db_ptr(el) {}
 
 /// \brief Applies a combined value+name filter on all leaves.
 /// \details Passes through empty name+value nodes; otherwise requires both matches.
+/// Runs on the search index of the DB (built on the first call), see SearchIndex.
 void Filter::FilterDB::find_el(Filter::filterElem* _f) 
 {
-    for (auto& ch : db_ptr->get_childs())
-
-        walk_set_vis(ch,_f, [&](BASE& b,filterElem* f){
-            if (f->name.has_value() && !contains(to_lowercase_view(b.get_name()),to_lowercase_view(*f->name)))
-                return false;
-
-            if (f->comment.has_value() && !contains(to_lowercase_view(b.get_comment()), to_lowercase_view(*f->comment)))
-                return false;
-                            
-            if (f->value_in.has_value())
-            {
-                const auto& bval = b.get_data();
-                const auto& fval = *f->value_in;
-                if (!variant_matches(bval, fval))
-                    return false;
-            }
-            return true;
-        }); 
+    auto index = SearchIndex::of(db_ptr);
+    index->build();
+
+    std::vector<Value> values;
+    if (_f->value_in.has_value()) values = index->capture_values(*db_ptr);
+    BoolPlane bools;
+    if (_f->bool_el.has_value()) bools = index->capture_bools(*db_ptr);
+
+    VisBitmap vis;
+    index->evaluate(*_f, _f->value_in.has_value() ? &values : nullptr,
+                    _f->bool_el.has_value() ? &bools : nullptr, vis);
+    index->apply(vis, nullptr);
 }
  
 void Filter::FilterDB::resetAll() 
 {
-    Filter::filterElem* nullFilter;
-    for (auto& ch : db_ptr->get_childs())
-        walk_set_vis(ch,nullFilter, [&](BASE& b,filterElem* f)
+    Filter::filterElem* nullFilter = nullptr;
+    walk_set_vis(db_ptr->get_childs(),nullFilter, [&](BASE& b,filterElem* f)
         {
             return true;
         }); 
@@ -140,10 +93,10 @@ VariantElement class_utils::create_element(const VariantElement& el,std::shared_
         using T = std::decay_t<decltype(ptr)>;
 
         if constexpr (std::is_same_v<T, std::shared_ptr<STD_SINGLE>>){
-            return std::make_shared<STD_SINGLE>(ptr->get_name(), ptr->get_type(),par);
+            return arena::make<STD_SINGLE>(ptr->get_name(), ptr->get_type(),par);
         }
         if constexpr (std::is_same_v<T, std::shared_ptr<STD_ARR_ELEM>>){
-            return std::make_shared<STD_ARR_ELEM>(ptr->get_name(), ptr->get_type(),ptr->get_index(),ptr->get_max_index(),par);
+            return arena::make<STD_ARR_ELEM>(ptr->get_name(), ptr->get_type(),ptr->get_index(),ptr->get_max_index(),par);
         }
         else if constexpr (std::is_same_v<T, std::shared_ptr<STD_ARRAY>>){
             return STD_ARRAY::create_array(ptr->get_name(), ptr->get_type(), ptr->get_start(), ptr->get_end(),par);                
@@ -153,10 +106,10 @@ VariantElement class_utils::create_element(const VariantElement& el,std::shared_
         } 
         else if constexpr (std::is_same_v<T, std::shared_ptr<UDT_ARR_ELEM>>){
             
-            return std::make_shared<UDT_ARR_ELEM>(ptr,par);
+            return arena::make<UDT_ARR_ELEM>(ptr,par);
         }     
         else if constexpr (std::is_same_v<T, std::shared_ptr<UDT_ARRAY>>){
-            return std::make_shared<UDT_ARRAY>(ptr,par);
+            return arena::make<UDT_ARRAY>(ptr,par);
         }
         else if constexpr (std::is_same_v<T, std::shared_ptr<STRUCT_SINGLE>>){
             return STRUCT_SINGLE::create_from_element(ptr->get_name(),ptr->get_type(),ptr->get_childs(),par);
@@ -212,19 +165,52 @@ void class_utils::check_offset(std::pair<int,int>& offset_in,std::pair<int,int>&
     }
 };
 
-/// \brief Resolves TIA basic type size from the lookup table.
+/// \brief Appends every leaf below \p el (or \p el itself if it is a leaf) to \p out.
+void class_utils::collect_leaves(const VariantElement& el,std::vector<BASE*>& out)
+{
+    tree_walk::walk(&el, 1, [&](const VariantElement& node) {
+        std::visit([&](const auto& ptr) {
+            using T = std::decay_t<decltype(*ptr)>;
+            if constexpr (std::is_base_of_v<BASE, T>) out.push_back(ptr.get());
+        }, node);
+        return true;
+    }, [](const VariantElement&) {});
+}
+
+/// \brief Counter of materializations, see tree_generation().
+static std::atomic<unsigned long> generation{0};
+
+/// \brief Increases whenever lazily built nodes (UDT array elements) are added to a tree,
+/// so holders of leaf lists know they must collect them again.
+unsigned long class_utils::tree_generation(){return generation.load(std::memory_order_relaxed);}
+
+/// \brief Marks that nodes were added to a tree.
+void class_utils::bump_tree_generation(){generation.fetch_add(1,std::memory_order_relaxed);}
+
+/// \brief Counter of visibility changes, see vis_generation().
+static std::atomic<unsigned long> vis_changes{0};
+
+/// \brief Increases whenever an element is shown or hidden (by a filter), so views of the
+/// visible tree know they must rebuild.
+unsigned long class_utils::vis_generation(){return vis_changes.load(std::memory_order_relaxed);}
+
+/// \brief Resolves TIA basic type size from the type table.
 /// \param type Type name (case-insensitive).
 /// \return {bytes,bits}.
 /// \throws std::logic_error if type is unknown.
 std::pair<int,int> class_utils::get_size(std::string type){
-    auto it = tia_type_size.find(to_lowercase(type));
-    
-    if(it == tia_type_size.end()){ 
-        std::cerr<<type<<"\n";
-        throw std::logic_error("Invalid element type");
-    }
-    return it->second;
-};
+    TiaType code = tia::code_of(type);
+    if(code == TiaType::Unknown) std::cerr<<type<<"\n";
+    return get_size(code);
+}
+
+/// \brief TIA basic type size of a resolved type code.
+/// \return {bytes,bits}.
+/// \throws std::logic_error if \p type is TiaType::Unknown.
+std::pair<int,int> class_utils::get_size(TiaType type){
+    if(type == TiaType::Unknown) throw std::logic_error("Invalid element type");
+    return tia::size_of(type);
+}
 
 
 
@@ -270,21 +256,20 @@ std::string translate::get_string(const std::vector<unsigned char>& buffer, int
 /// \param buffer Source bytes.
 /// \param offset_in {byte,bit} offset.
 /// \param type_in TIA type (case-insensitive).
-/// \return Value variant (bool/int/string) depending on type; 0 if unknown type.
+/// \return Value variant (bool/int/int64/uint64/float/double/TimeValue/string) depending on type; 0 if unknown type or out of the buffer.
+/// \note Resolves the name on every call; the decode paths use the type code instead.
 Value translate::generic_get(const std::vector<unsigned char>& buffer, std::pair<int,int>offset_in, const std::string& type_in) {
-    std::string type_of = to_lowercase(type_in);
-    auto it = tia_type_size.find(type_of);
-    if (it == tia_type_size.end()) return 0;
-
-    int length = it->second.first;
-
-    if (type_of == "bool") {
-        return get_bool(buffer, offset_in.first, offset_in.second);
-    } else if (type_of == "string" || type_of =="char") {
-        return get_string(buffer, offset_in.first, length);
-    } else {
-        return get_int(buffer, offset_in.first, length);
-    }
+    TiaType code = tia::code_of(type_in);
+    int length = tia::size_of(code).first;
+    if (offset_in.first < 0 || static_cast<size_t>(offset_in.first + std::max(length,1)) > buffer.size()) return 0;
+    return tia::read(code, buffer.data() + offset_in.first, offset_in.second, length);
+}
+
+/// \brief Decodes one layout record through the compile-time reader of its type.
+/// \param rec Record from DB::get_layout() (bounds checked by the caller).
+Value translate::decode(const LeafRecord& rec,const std::vector<unsigned char>& buffer)
+{
+    return tia::read(rec.type, buffer.data() + rec.offset, rec.bit, rec.len);
 }
 
 /// \brief Parses a boolean string ("true"/"false").
@@ -298,50 +283,74 @@ bool translate::parse_bool(std::string& bool_in)
         return false;
 }
 
-/// \brief Parses a literal into a Value (int -> Value, "true/false" -> bool, otherwise string).
+/// \brief Parses a literal into a Value (int, int64, double, "true/false" -> bool, otherwise string).
 /// \param input Input lexeme (will be lowercased for bool test).
 /// \return Parsed Value.
-/// \note Falls back to returning the original string if not an int/bool.
+/// \note Integers beyond int become int64; a literal is numeric only if it is consumed whole.
+/// Falls back to returning the original string if not a number/bool.
 Value translate::parse_type(std::string& input)
 {
-    Value output;
+    size_t used = 0;
     try {
-    output = std::stoi(input);
-    return output;
-
+        long long n = std::stoll(input, &used);
+        if (used == input.size()) {
+            if (n >= std::numeric_limits<int>::min() && n <= std::numeric_limits<int>::max())
+                return static_cast<int>(n);
+            return static_cast<std::int64_t>(n);
+        }
+    } catch (const std::invalid_argument&) {
+        // not an integer
+    } catch (const std::out_of_range&) {
+        // out of int64 range, may still be a double
+    }
+    // stod also takes "inf"/"nan", which are names rather than values here.
+    const bool numeric = !input.empty() && (std::isdigit(static_cast<unsigned char>(input[0])) ||
+                         input[0] == '-' || input[0] == '+' || input[0] == '.');
+    if (numeric) try {
+        double d = std::stod(input, &used);
+        if (used == input.size()) return d;
     } catch (const std::invalid_argument&) {
-        // not an int
+        // not a number
     } catch (const std::out_of_range&) {
-        // out of int range
+        // not representable
     }
     std::string input_low = to_lowercase(input); 
     if( input_low == "true" || input_low == "false")
         return parse_bool(input_low);
-    
-       // std::cout << typeid().name() << "\n";
+
     return input;
 }
 
-/// \brief Sets the parent container pointer on this element.
-/// \param in Parent container (shared).
-void Element::set_parent(std::shared_ptr<BASE_CONTAINER> in ){parent = in;}
+/// \brief Sets the parent container pointer on this element (not owned).
+/// \param in Parent container.
+void Element::set_parent(const std::shared_ptr<BASE_CONTAINER>& in ){parent = in.get();}
+
+/// \brief Sets the parent container pointer on this element (not owned).
+void Element::set_parent(BASE_CONTAINER* in ){parent = in;}
 
 /// \brief Gets the parent container pointer.
-/// \return Parent container (shared) or nullptr.
-std::shared_ptr<BASE_CONTAINER> Element::get_parent()const {return parent;}
+/// \return Parent container or nullptr.
+BASE_CONTAINER* Element::get_parent()const {return parent;}
+
+/// \brief Comment of the elements the source gives none for.
+const PooledString& BASE::no_comment()
+{
+    static const PooledString comment(string_pool::constants(), "xyz");
+    return comment;
+}
 
 /// \brief BASE leaf constructor (name + type).
 BASE::BASE(std::string name_in, std::string type_in) :
-    name(name_in), type(type_in) {}
+    name(name_in), type(type_in), type_code(tia::code_of(type_in)) {}
 
 /// \brief Gets element name.
-std::string BASE::get_name()const{return name;}
+const std::string& BASE::get_name()const{return name;}
 
 /// \brief Gets element type.
-std::string BASE::get_type()const{return type;}
+const std::string& BASE::get_type()const{return type;}
 
 /// \brief Gets element comment.
-std::string BASE::get_comment()const{return comment;}
+const std::string& BASE::get_comment()const{return comment;}
 
 /// \brief Gets byte/bit offset of the element.
 std::pair<int,int> BASE::get_offset() const { return offset;}
@@ -356,18 +365,41 @@ bool BASE::get_vis() {return is_vis;}
 void BASE::set_name(std::string name_in){ name = name_in;}
 
 /// \brief Sets element type.
-void BASE::set_type(std::string type_in){ type = type_in;}
+void BASE::set_type(std::string type_in){ type = type_in; type_code = tia::code_of(type_in);}
+
+/// \brief Gets the type code resolved when the type was set.
+TiaType BASE::get_type_code() const{return type_code;}
+
+/// \brief Gets element size {bytes,bits}, valid after set_offset.
+std::pair<int,int> BASE::get_size() const{return size;}
+
+/// \brief Gets the index of this leaf in its DB layout table, -1 before layout.
+int BASE::get_leaf_id() const{return leaf_id;}
+
+/// \brief Sets an already decoded value.
+void BASE::set_value(Value value_in){data = std::move(value_in);}
+
+/// \brief Sets the index of this leaf in its DB layout table.
+void BASE::set_leaf_id(int id_in){leaf_id = id_in;}
 
 /// \brief Decodes data from buffer according to type and this element's offset.
-void BASE::set_data(const std::vector<unsigned char>& buffer){data = translate::generic_get(buffer,offset,type);};
+void BASE::set_data(const std::vector<unsigned char>& buffer){
+    if(offset.first < 0 || static_cast<size_t>(offset.first + std::max(size.first,1)) > buffer.size()) return;
+    data = tia::read(type_code, buffer.data() + offset.first, offset.second, size.first);
+};
 
 /// \brief Sets visibility flag.
-void BASE::set_vis(bool b_in) {is_vis = b_in;};
+void BASE::set_vis(bool b_in) {
+    if(is_vis == b_in) return;
+    is_vis = b_in;
+    vis_changes.fetch_add(1,std::memory_order_relaxed);
+};
 
 /// \brief Assigns offset to this element and advances a running offset cursor.
 /// \param offset_in [in/out] Current {byte,bit} position advanced by this element size.
 void BASE::set_offset(std::pair<int,int>& offset_in){
-   std::pair<int,int> size = class_utils::get_size(type);
+    if(type_code == TiaType::Unknown) std::cerr<<type<<"\n";
+    size = class_utils::get_size(type_code);
 
     class_utils::check_offset(offset_in,size);
 
@@ -376,21 +408,27 @@ void BASE::set_offset(std::pair<int,int>& offset_in){
     offset_in.second +=size.second;
 };
 
+/// \brief Restores an offset computed by a previous layout (e.g. from the DB cache).
+void BASE::set_layout(std::pair<int,int> offset_in){
+    offset = offset_in;
+    size = class_utils::get_size(type_code);
+}
+
 /// \brief BASE_CONTAINER constructor (name + type).
 BASE_CONTAINER::BASE_CONTAINER(std::string name_in,std::string type_in) 
     : name(name_in), type(type_in){}
 
 /// \brief Gets container name.
-std::string BASE_CONTAINER::get_name()const{return name;}
+const std::string& BASE_CONTAINER::get_name()const{return name;}
 
 /// \brief Gets container type.
-std::string BASE_CONTAINER::get_type()const{return type;}
+const std::string& BASE_CONTAINER::get_type()const{return type;}
 
 /// \brief Gets children as variant list.
-std::vector<VariantElement> BASE_CONTAINER::get_childs() const {return childs;}
+const std::vector<VariantElement>& BASE_CONTAINER::get_childs() const {return childs;}
 
 /// \brief Gets name-to-element associations (if used).
-std::vector<std::pair<std::string,VariantElement>> BASE_CONTAINER::get_names()const {return names;}
+const std::vector<std::pair<std::string,VariantElement>>& BASE_CONTAINER::get_names()const {return names;}
 
 /// \brief Gets visibility flag.
 bool BASE_CONTAINER::get_vis() {return is_vis;}
@@ -408,52 +446,44 @@ void BASE_CONTAINER::insert_child(VariantElement el){ childs.push_back(el);}
 void BASE_CONTAINER::add_name(std::pair<std::string,VariantElement> el){names.push_back(el);}
 
 /// \brief Sets visibility flag on container.
-void BASE_CONTAINER::set_vis(bool b_in){ is_vis = b_in; };
+void BASE_CONTAINER::set_vis(bool b_in){
+    if(is_vis == b_in) return;
+    is_vis = b_in;
+    vis_changes.fetch_add(1,std::memory_order_relaxed);
+};
 
 
 /// \brief Propagates buffer decoding to leaf children (recursively for subcontainers).
 /// \param buffer Source bytes from PLC DB.
 void BASE_CONTAINER::set_data_to_child(const std::vector<unsigned char>& buffer){
-    for(auto i : childs){
-        std::visit([&](auto&& ptr) {
-        using T = std::decay_t<decltype(ptr)>;
+    tree_walk::walk(childs, [&](const VariantElement& el) {
+        return std::visit([&](const auto& ptr) -> bool {
+            using T = std::decay_t<decltype(ptr)>;
 
-        if constexpr (std::is_same_v<T, std::shared_ptr<STD_SINGLE>>||
-                    std::is_same_v<T, std::shared_ptr<STD_ARR_ELEM>>){
-            
-            ptr->set_data(buffer);
-        }
-        else if constexpr (
-            std::is_same_v<T, std::shared_ptr<UDT_ARRAY>> ||
-            std::is_same_v<T, std::shared_ptr<UDT_SINGLE>> ||
-            std::is_same_v<T, std::shared_ptr<STD_ARRAY>>  ||
-            std::is_same_v<T, std::shared_ptr<UDT_ARR_ELEM>> ||
-            std::is_same_v<T, std::shared_ptr<STRUCT_SINGLE>>
-        ) {ptr->set_data_to_child(buffer) ;}
-    },i);
-    }
-};
-
-/// \brief Assigns offsets to all children in order, updating a running cursor.
-/// \param actual_offset [in/out] Accumulated byte/bit offset.
-void BASE_CONTAINER::set_child_offset(std::pair<int,int>& actual_offset){
-    for(auto& i : childs){
-            check_type_for_offset(i,actual_offset);
-        }
+            if constexpr (std::is_same_v<T, std::shared_ptr<STD_SINGLE>>||
+                        std::is_same_v<T, std::shared_ptr<STD_ARR_ELEM>>){
+                ptr->set_data(buffer);
+                return false;
+            }
+            else return !std::is_same_v<T, std::shared_ptr<STRUCT_ARRAY>> &&
+                        !std::is_same_v<T, std::shared_ptr<STRUCT_ARRAY_EL>>;
+        }, el);
+    });
 };
 
-/// \brief Dispatches offset assignment by concrete child type, handling alignment for containers.
-/// \param elem Child variant.
-/// \param actual_offset [in/out] Accumulated byte/bit offset.
-void BASE_CONTAINER::check_type_for_offset(VariantElement& elem,std::pair<int,int>& actual_offset)
+/// \brief Layout step of one element: a leaf takes the next offset, a container is aligned
+/// and then descended into (a UDT array lays itself out from its prototype).
+/// \return true if the walk has to visit the children of \p elem.
+static bool layout_element(const VariantElement& elem,std::pair<int,int>& actual_offset)
 {
-    std::visit([&](auto&& ptr) {
+    return std::visit([&](const auto& ptr) -> bool {
         using T = std::decay_t<decltype(ptr)>;
 
         if constexpr (std::is_same_v<T, std::shared_ptr<STD_SINGLE>>||
                     std::is_same_v<T, std::shared_ptr<STD_ARR_ELEM>>){
             
             ptr->set_offset(actual_offset);
+            return false;
         }
         else if constexpr (
             std::is_same_v<T, std::shared_ptr<UDT_ARRAY>> ||
@@ -467,10 +497,29 @@ void BASE_CONTAINER::check_type_for_offset(VariantElement& elem,std::pair<int,in
                 actual_offset.second = 0;
             }
             class_utils::apply_padding(actual_offset);
-            ptr->set_child_offset(actual_offset);
-
+            if constexpr (std::is_same_v<T, std::shared_ptr<UDT_ARRAY>>) {
+                ptr->set_child_offset(actual_offset);
+                return false;
+            }
+            return true;
         }
+        else return false;
     },elem);
+}
+
+/// \brief Assigns offsets to all children in order, updating a running cursor.
+/// \param actual_offset [in/out] Accumulated byte/bit offset.
+void BASE_CONTAINER::set_child_offset(std::pair<int,int>& actual_offset){
+    tree_walk::walk(childs, [&](const VariantElement& el) { return layout_element(el, actual_offset); });
+};
+
+/// \brief Dispatches offset assignment by concrete child type, handling alignment for containers.
+/// \param elem Child variant.
+/// \param actual_offset [in/out] Accumulated byte/bit offset.
+void BASE_CONTAINER::check_type_for_offset(VariantElement& elem,std::pair<int,int>& actual_offset)
+{
+    tree_walk::walk(&elem, 1, [&](const VariantElement& el) { return layout_element(el, actual_offset); },
+                    [](const VariantElement&) {});
 };
 
 /// \brief UDT_RAW constructor holding the raw name only.
@@ -478,7 +527,7 @@ UDT_RAW::UDT_RAW(std::string name) :
     raw_name(name) {}
 
 /// \brief Gets the raw UDT name.
-std::string UDT_RAW::get_name() const { return raw_name;}
+const std::string& UDT_RAW::get_name() const { return raw_name;}
 
 /// \brief Gets raw child elements of this UDT.
 const std::vector<VariantElement>& UDT_RAW::get_childs() const { return childs;}
@@ -518,25 +567,24 @@ STD_ARRAY::STD_ARRAY(const std::string& n_in,const std::string& t_in,int st,int
     : BASE_CONTAINER(n_in,t_in),index_start(st),index_end(end){this->set_parent(parent);}
 
 /// \brief Factory to create a STD array container with indexed children.
-/// \throws std::logic_error if element type is unknown in \c tia_type_size.
+/// \throws std::logic_error if element type is not a TIA basic type.
 std::shared_ptr<STD_ARRAY> STD_ARRAY::create_array
     (const std::string& n_in,const std::string& t_in,int st,int end,std::shared_ptr<BASE_CONTAINER> parent) 
     {   
-        auto arr = std::make_shared<STD_ARRAY>();
+        auto arr = arena::make<STD_ARRAY>();
         arr->name = n_in;
         arr->type = t_in;
         arr->index_start = st ;
         arr->index_end = end;
         
-        auto it = tia_type_size.find(to_lowercase(t_in));
-        if(it == tia_type_size.end()){ 
+        if(tia::code_of(t_in) == TiaType::Unknown){ 
             std::cerr <<"element name "<< to_lowercase(t_in)<< "\n";
             throw std::logic_error("Invalid element type");
         }
       
         for (int i = st; i <= end; ++i) {
             std::string indexed_name = n_in + "[" + std::to_string(i) + "]";
-            VariantElement el = std::make_shared<STD_ARR_ELEM>(indexed_name, t_in, i,end,arr);
+            VariantElement el = arena::make<STD_ARR_ELEM>(indexed_name, t_in, i,end,arr);
             arr->childs.push_back(el);
         }
         return arr;
@@ -551,7 +599,7 @@ UDT_SINGLE::UDT_SINGLE(std::string name_in ,std::string type_in)
 std::shared_ptr<UDT_SINGLE> UDT_SINGLE::create_from_element
     (std::string n_in,std::string t_in,const std::vector<VariantElement>& el,std::shared_ptr<BASE_CONTAINER> parent)
     {
-        std::shared_ptr<UDT_SINGLE> self = std::make_shared<UDT_SINGLE>(n_in,t_in);
+        std::shared_ptr<UDT_SINGLE> self = arena::make<UDT_SINGLE>(n_in,t_in);
         self->set_parent(parent);
         ElementInfo info;
         info.is_arr = false; // =^.^=
@@ -572,14 +620,14 @@ UDT_ARR_ELEM::UDT_ARR_ELEM(std::shared_ptr<UDT_ARR_ELEM> el,std::shared_ptr<BASE
         index = el->get_index();
         max_index = el->get_max_index();
         childs = el->get_childs();
-        parent = par;
+        parent = par.get();
     }
 
 /// \brief Factory to create a UDT_ARR_ELEM from a UDT_SINGLE base template.
 std::shared_ptr<UDT_ARR_ELEM> UDT_ARR_ELEM::create_from_element
     (std::shared_ptr<UDT_SINGLE> el,int arr_nr,int max_arr_nr,std::shared_ptr<BASE_CONTAINER> parent)
     {
-        std::shared_ptr<UDT_ARR_ELEM> self = std::make_shared<UDT_ARR_ELEM>();
+        std::shared_ptr<UDT_ARR_ELEM> self = arena::make<UDT_ARR_ELEM>();
         std::string indexed_name= el->get_name()+"["+ std::to_string(arr_nr) +"]";
         self->set_name(indexed_name);
         self->set_type(el->get_type());
@@ -594,6 +642,8 @@ std::shared_ptr<UDT_ARR_ELEM> UDT_ARR_ELEM::create_from_element
     }
 
 /// \brief UDT array copy-constructor from an existing array instance.
+/// \details The prototype is cloned (templates may be shared between threads); materialized
+/// elements are not copied.
 /// \param el Source UDT_ARRAY to clone.
 /// \param par New parent.
 UDT_ARRAY::UDT_ARRAY(std::shared_ptr<UDT_ARRAY> el,std::shared_ptr<BASE_CONTAINER> par)
@@ -601,15 +651,16 @@ UDT_ARRAY::UDT_ARRAY(std::shared_ptr<UDT_ARRAY> el,std::shared_ptr<BASE_CONTAINE
     {
         index_start = el->get_start();
         index_end = el->get_end();
-        childs = el->get_childs();
-        parent = par;
+        parent = par.get();
+        if(auto proto = el->get_prototype())
+            prototype = UDT_SINGLE::create_from_element(proto->get_name(),proto->get_type(),proto->get_childs(),nullptr);
     }
     
 /// \brief Gets UDT array name.
-std::string UDT_ARRAY::get_name()const{return name;};
+const std::string& UDT_ARRAY::get_name()const{return name;};
 
 /// \brief Gets UDT array type.
-std::string UDT_ARRAY::get_type()const{return type;}
+const std::string& UDT_ARRAY::get_type()const{return type;}
 
 /// \brief Gets start index.
 int UDT_ARRAY::get_start()const{return index_start;}
@@ -617,8 +668,145 @@ int UDT_ARRAY::get_start()const{return index_start;}
 /// \brief Gets end index.
 int UDT_ARRAY::get_end()const{return index_end;}
 
-/// \brief Factory to create a UDT_ARRAY by replicating a UDT_SINGLE template.
-/// \param el Raw children used to build the base template instance.
+/// \brief Number of elements (end - start + 1).
+int UDT_ARRAY::get_count()const{return std::max(index_end - index_start + 1,0);}
+
+/// \brief Bytes between the starts of two elements, valid after layout.
+int UDT_ARRAY::get_stride()const{return stride;}
+
+/// \brief Offset of the first element, valid after layout.
+std::pair<int,int> UDT_ARRAY::get_base()const{return base;}
+
+/// \brief Element layout shared by all indices (offsets relative to the element start).
+std::shared_ptr<UDT_SINGLE> UDT_ARRAY::get_prototype()const{return prototype;}
+
+/// \brief Sets the element layout; the array must be laid out again afterwards.
+void UDT_ARRAY::set_prototype(std::shared_ptr<UDT_SINGLE> proto_in){prototype = std::move(proto_in);}
+
+/// \brief Element \p index if it was materialized, nullptr otherwise.
+std::shared_ptr<UDT_ARR_ELEM> UDT_ARRAY::find_element(int index)const
+{
+    auto it = elements.find(index);
+    return it == elements.end() ? nullptr : it->second;
+}
+
+/// \brief Element \p index, materialized from the prototype on first use.
+/// \throws std::out_of_range if \p index is outside [start,end].
+std::shared_ptr<UDT_ARR_ELEM> UDT_ARRAY::get_element(int index)
+{
+    if(auto el = find_element(index)) return el;
+    auto el = _materialize(index);
+    _sync_childs();
+    class_utils::bump_tree_generation();
+    return el;
+}
+
+/// \brief Materializes every element (e.g. to search all of them).
+void UDT_ARRAY::materialize_all()
+{
+    if(static_cast<int>(elements.size()) == get_count()) return;
+    for(int i = index_start; i <= index_end; ++i)
+        if(elements.count(i) == 0) _materialize(i);
+    _sync_childs();
+    class_utils::bump_tree_generation();
+}
+
+/// \brief False if a filter hid element \p index (materialized or not).
+bool UDT_ARRAY::get_element_vis(int index)const
+{
+    const int k = index - index_start;
+    return k < 0 || k >= static_cast<int>(hidden.size()) || !hidden[k];
+}
+
+/// \brief Shows or hides element \p index in the views, whether it is materialized or not.
+void UDT_ARRAY::set_element_vis(int index,bool on)
+{
+    const int k = index - index_start;
+    if(k < 0 || k >= get_count() || get_element_vis(index) == on) return;
+    if(hidden.empty()) hidden.assign(get_count(), false);
+    hidden[k] = !on;
+    vis_changes.fetch_add(1,std::memory_order_relaxed);
+}
+
+/// \brief Shows every element again.
+void UDT_ARRAY::show_all_elements()
+{
+    if(hidden.empty()) return;
+    hidden.clear();
+    vis_changes.fetch_add(1,std::memory_order_relaxed);
+}
+
+/// \brief Lays out the prototype from {0,0} and derives the stride; materialized elements are
+/// moved to their new place.
+/// \param base_in Offset of the first element (already aligned by the caller).
+void UDT_ARRAY::set_layout(std::pair<int,int> base_in)
+{
+    base = base_in;
+    tail = {0,0};
+    if(prototype != nullptr) prototype->set_child_offset(tail);
+
+    // Same advance the layout applies between two consecutive containers.
+    std::pair<int,int> next = tail;
+    if(next.second > 1){
+        ++next.first;
+        next.second = 0;
+    }
+    class_utils::apply_padding(next);
+    stride = next.first;
+
+    for(auto& [i, el] : elements) _place(i,*el);
+}
+
+/// \brief Lays out the array at \p actual_offset and advances it past the last element.
+void UDT_ARRAY::set_child_offset(std::pair<int,int>& actual_offset)
+{
+    set_layout(actual_offset);
+    if(get_count() > 0)
+        actual_offset = {base.first + (get_count() - 1) * stride + tail.first, tail.second};
+}
+
+/// \brief Builds element \p index from the prototype.
+/// \throws std::out_of_range if \p index is outside [start,end].
+std::shared_ptr<UDT_ARR_ELEM> UDT_ARRAY::_materialize(int index)
+{
+    if(index < index_start || index > index_end || prototype == nullptr)
+        throw std::out_of_range("UDT array index out of range");
+
+    arena::Scope scope(tree_arena);
+    auto el = arena::make<UDT_ARR_ELEM>();
+    el->set_parent(this);
+    el->set_name(name.get() + "[" + std::to_string(index) + "]");
+    el->set_type(type);
+    el->set_index(index);
+    el->set_max_index(index_end);
+    for(const auto& ch : prototype->get_childs()){
+        auto new_el = class_utils::create_element(ch,el);
+        std::visit([&](auto&& ptr){ ptr->set_parent(el);},new_el);
+        el->insert_child(new_el);
+    }
+    _place(index,*el);
+    elements[index] = el;
+    return el;
+}
+
+/// \brief Lays out a materialized element at its place in the array.
+void UDT_ARRAY::_place(int index,UDT_ARR_ELEM& el)
+{
+    std::pair<int,int> at = {base.first + (index - index_start) * stride, 0};
+    el.set_child_offset(at);
+}
+
+/// \brief Refreshes childs with the materialized elements, in index order.
+void UDT_ARRAY::_sync_childs()
+{
+    childs.clear();
+    childs.reserve(elements.size());
+    for(const auto& [i, el] : elements) childs.push_back(el);
+}
+
+/// \brief Factory to create a UDT_ARRAY from the UDT definition.
+/// \details Only the prototype element is built; elements are materialized on demand.
+/// \param el Raw children of the UDT.
 /// \param start First index (inclusive).
 /// \param end Last index (inclusive).
 std::shared_ptr<UDT_ARRAY> UDT_ARRAY::create_from_element
@@ -631,23 +819,13 @@ std::shared_ptr<UDT_ARRAY> UDT_ARRAY::create_from_element
     std::shared_ptr<BASE_CONTAINER> parent
 )
 {
-    std::shared_ptr<UDT_ARRAY> self = std::make_shared<UDT_ARRAY>();
+    std::shared_ptr<UDT_ARRAY> self = arena::make<UDT_ARRAY>();
     self->set_name(name_in);
     self->set_type(type_in);
     self->set_parent(parent);
-
-    std::shared_ptr<UDT_SINGLE> base_el = std::make_shared<UDT_SINGLE>(name_in,type_in);
-    base_el->set_parent(self);
-    for(auto i : el){
-        auto new_el = class_utils::create_element(i,self);
-        std::visit([&](auto&& ptr){ ptr->set_parent(self);},new_el);
-        base_el->insert_child(new_el);
-    }   
-
-    for(auto i = start; i <= end;++i){
-        auto container = UDT_ARR_ELEM::create_from_element(base_el,i,end,self);
-        self->insert_child(container);
-    }
+    self->set_start(start);
+    self->set_end(end);
+    self->set_prototype(UDT_SINGLE::create_from_element(name_in,type_in,el,self));
     return self;     
 }
 
@@ -656,16 +834,20 @@ STRUCT_SINGLE::STRUCT_SINGLE( std::string& name_in,std::string type_in)
     : BASE_CONTAINER(name_in,"Struct"){}
 
 /// \brief Gets struct display name.
-std::string STRUCT_SINGLE::get_name() const { return name; }
+const std::string& STRUCT_SINGLE::get_name() const { return name; }
 
 /// \brief Gets struct display type (always "Struct").
-std::string STRUCT_SINGLE::get_type() const { return "Struct";}
+const std::string& STRUCT_SINGLE::get_type() const
+{
+    static const PooledString struct_type(string_pool::constants(), "Struct");
+    return struct_type;
+}
     
 /// \brief Factory to create a STRUCT_SINGLE from raw children.
 std::shared_ptr<STRUCT_SINGLE> STRUCT_SINGLE::create_from_element
     (std::string n_in,std::string t_in,const std::vector<VariantElement> el,std::shared_ptr<BASE_CONTAINER> parent)
     {
-        std::shared_ptr<STRUCT_SINGLE> self = std::make_shared<STRUCT_SINGLE>(n_in,t_in);
+        std::shared_ptr<STRUCT_SINGLE> self = arena::make<STRUCT_SINGLE>(n_in,t_in);
         self->set_parent(parent);
         ElementInfo info;
         info.is_arr = false;
@@ -707,7 +889,7 @@ std::shared_ptr<STRUCT_ARRAY_EL> STRUCT_ARRAY_EL::create_from_element
         std::shared_ptr<BASE_CONTAINER> parent
     )
     {
-        std::shared_ptr<STRUCT_ARRAY_EL> self = std::make_shared<STRUCT_ARRAY_EL>(name_in,idx,idx_max,"Struct");
+        std::shared_ptr<STRUCT_ARRAY_EL> self = arena::make<STRUCT_ARRAY_EL>(name_in,idx,idx_max,"Struct");
         self->set_parent(parent);
         ElementInfo info;
         info.is_arr = false;
@@ -725,10 +907,14 @@ STRUCT_ARRAY::STRUCT_ARRAY( std::string& name_in,std::string type_in)
     : BASE_CONTAINER(name_in,"Struct"){}
 
 /// \brief Gets struct array display name.
-std::string STRUCT_ARRAY::get_name() const { return name; }
+const std::string& STRUCT_ARRAY::get_name() const { return name; }
 
 /// \brief Gets struct array display type (always "Struct").
-std::string STRUCT_ARRAY::get_type() const { return "Struct";}
+const std::string& STRUCT_ARRAY::get_type() const
+{
+    static const PooledString struct_type(string_pool::constants(), "Struct");
+    return struct_type;
+}
 
 /// \brief Gets array start index (inclusive).
 int STRUCT_ARRAY::get_start()const{return start;}
@@ -736,6 +922,12 @@ int STRUCT_ARRAY::get_start()const{return start;}
 /// \brief Gets array end index (inclusive).
 int STRUCT_ARRAY::get_end()const{return end;}
 
+/// \brief Sets array start index (inclusive).
+void STRUCT_ARRAY::set_index(int i){start = i;}
+
+/// \brief Sets array end index (inclusive).
+void STRUCT_ARRAY::set_max_index(int i){end = i;}
+
 /// \brief Factory to create a STRUCT_ARRAY by replicating a STRUCT template across indices.
 /// \warning The current implementation constructs children under \c self inside the loop
 /// but does not initialize \c self before usage; ensure \c self is created and parented first.
@@ -774,7 +966,7 @@ std::shared_ptr<STRUCT_ARRAY> STRUCT_ARRAY::create_from_element
 DB::DB(std::string name_in) :BASE_CONTAINER(name_in,"DB"){};
 
 /// \brief Gets DB name.
-std::string DB::get_name() const{return name;}
+const std::string& DB::get_name() const{return name;}
 
 /// \brief Gets maximum computed offset after layout.
 std::pair<int,int> DB::get_max_offset()const{return offset_max;}
@@ -782,11 +974,244 @@ std::pair<int,int> DB::get_max_offset()const{return offset_max;}
 /// \brief Sets maximum offset.
 void DB::set_max_offset(std::pair<int,int> ofst){offset_max = ofst;}
 
-/// \brief Computes children offsets starting from current max offset.
-void DB::_set_offset(){set_child_offset(offset_max);}
+/// \brief Leaves of the DB in layout order, valid after _set_offset.
+const std::vector<BASE*>& DB::get_leaves()const{return leaves;}
+
+/// \brief Flat layout table (one record per leaf, same order as get_leaves()).
+const std::vector<LeafRecord>& DB::get_layout()const{return layout;}
+
+/// \brief Leaves whose bytes changed (and were re-decoded) by the last _set_data.
+const std::vector<BASE*>& DB::get_changed()const{return changed;}
+
+/// \brief Counter of the decodes whose buffer differed from the previous one (bytes of
+/// leaves that are not decoded, e.g. UDT array elements read by the search index, count too).
+unsigned long DB::get_data_version()const{return data_version;}
+
+/// \brief Buffer of the last decode, empty before the first one.
+const std::vector<unsigned char>& DB::get_buffer()const{return prev_buffer;}
+
+/// \brief Values of the Bool leaves, bit \c id of the vector for leaf \c id; 0 for the
+/// other leaves and for Bools not decoded yet.
+const std::vector<std::uint64_t>& DB::get_bool_bits()const{return bool_bits;}
+
+/// \brief Arena the nodes of this DB were built in, nullptr if they are on the heap.
+const std::shared_ptr<ElementArena>& DB::get_arena()const{return tree_arena;}
+
+/// \brief Records the arena the nodes of this DB were built in.
+void DB::set_arena(std::shared_ptr<ElementArena> arena_in){tree_arena = std::move(arena_in);}
+
+/// \brief Search index of this DB, nullptr until the first search.
+const std::shared_ptr<Filter::SearchIndex>& DB::get_search_index()const{return search_index;}
+
+/// \brief Caches the search index built for this DB.
+void DB::set_search_index(std::shared_ptr<Filter::SearchIndex> index){search_index = std::move(index);}
+
+/// \brief Computes children offsets starting from current max offset, then builds the
+/// flat layout table used by the decoder.
+void DB::_set_offset(){
+    set_child_offset(offset_max);
+    _build_layout();
+}
+
+/// \brief Indexes the leaves and builds the flat layout table from their offsets.
+void DB::_build_layout(){
+    leaves.clear();
+    for(const auto& ch : childs) class_utils::collect_leaves(ch,leaves);
+
+    std::vector<BASE*> found;
+    found.swap(leaves);
+    layout.clear();
+    bool_bits.clear();
+    layout.reserve(found.size());
+    for(BASE* leaf : found) _add_record(leaf);
+    prev_buffer.clear();
+}
+
+/// \brief Appends the layout record of \p leaf and gives it its leaf id.
+void DB::_add_record(BASE* leaf){
+    LeafRecord rec;
+    rec.offset = static_cast<std::uint32_t>(leaf->get_offset().first);
+    rec.bit = static_cast<std::uint8_t>(leaf->get_offset().second);
+    rec.type = leaf->get_type_code();
+    rec.len = static_cast<std::uint16_t>(leaf->get_size().first);
+    rec.id = static_cast<std::uint32_t>(leaves.size());
+
+    leaf->set_leaf_id(static_cast<int>(rec.id));
+    leaves.push_back(leaf);
+    layout.push_back(rec);
+    bool_bits.resize((layout.size() + 63) / 64, 0);
+}
+
+/// \brief Decodes the buffer into every leaf whose bytes changed since the previous call.
+/// \details Runs over the flat layout table, in offset order.
+void DB::_set_data(const std::vector<unsigned char>& buffer)
+{
+    changed.clear();
+    bool full = prev_buffer.size() != buffer.size();
+    if(!full && !_mark_dirty_chunks(buffer)) return;
+
+    if(full) _decode_all(0,layout.size(),buffer);
+    else for(const LeafRecord& rec : layout) _decode(rec,buffer,false);
+    prev_buffer = buffer;
+    ++data_version;
+}
+
+/// \brief Delta decoding of a subset of leaves.
+/// \details The buffer is compared with the previous one chunk by chunk; a leaf is decoded
+/// only if a chunk it spans differs and its own bytes (or bit) changed. Chunks use memcmp,
+/// which libc already vectorizes.
+/// Leaves materialized after the layout (UDT array elements) get their record here.
+/// \param subset Leaves of this DB to consider (e.g. the subscribed ones).
+/// \param force Decode every leaf of \p subset regardless of the previous buffer; needed
+/// when \p subset contains leaves that were not decoded from the previous buffer.
+void DB::_set_data(const std::vector<unsigned char>& buffer,const std::vector<BASE*>& subset,bool force)
+{
+    changed.clear();
+    bool full = force || prev_buffer.size() != buffer.size();
+    if(!full && !_mark_dirty_chunks(buffer)) return;
+
+    for(BASE* leaf : subset)
+        if(leaf->get_leaf_id() < 0) _add_record(leaf);
+
+    auto id_of = [&](size_t k){ return static_cast<size_t>(subset[k]->get_leaf_id()); };
+    for(size_t k = 0; k < subset.size(); ){
+        // Leaves with consecutive records (e.g. a whole array) are decoded as one run.
+        size_t first = id_of(k), n = 1;
+        if(full) while(k + n < subset.size() && id_of(k + n) == first + n) ++n;
+        if(first < layout.size()){
+            if(full) _decode_all(first,std::min(n,layout.size() - first),buffer);
+            else _decode(layout[first],buffer,false);
+        }
+        k += n;
+    }
+    prev_buffer = buffer;
+    ++data_version;
+}
+
+/// \brief Decodes \p rec into its leaf if it changed (or \p full), skipping records outside the buffer.
+void DB::_decode(const LeafRecord& rec,const std::vector<unsigned char>& buffer,bool full)
+{
+    if(rec.offset + std::max<size_t>(rec.len,1) > buffer.size()) return;
+    if(!full && !_leaf_changed(rec,buffer)) return;
+
+    BASE* leaf = leaves[rec.id];
+    leaf->set_value(translate::decode(rec,buffer));
+    changed.push_back(leaf);
 
-/// \brief Propagates buffer decoding to the entire DB.
-void DB::_set_data(const std::vector<unsigned char>& buffer){set_data_to_child(buffer);}
+    if(rec.type == TiaType::Bool){
+        const std::uint64_t mask = std::uint64_t(1) << (rec.id % 64);
+        if((buffer[rec.offset] >> rec.bit) & 1) bool_bits[rec.id / 64] |= mask;
+        else bool_bits[rec.id / 64] &= ~mask;
+    }
+}
+
+/// \brief Decodes the records [first, first + count) of the layout, changed or not.
+/// \details Back-to-back records of one fixed-size numeric or time type (the elements of an
+/// array) are decoded with one tia::read_array call instead of one read per element; runs
+/// of Bools on consecutive bits (Bool arrays, bit structs) go through _decode_bits().
+void DB::_decode_all(size_t first,size_t count,const std::vector<unsigned char>& buffer)
+{
+    thread_local std::vector<Value> run_values;
+    auto bit_of = [this](size_t i){ return size_t(layout[i].offset) * 8 + layout[i].bit; };
+
+    const size_t end = first + count;
+    for(size_t i = first; i < end; ){
+        const LeafRecord& rec = layout[i];
+        size_t j = i + 1;
+        if(rec.type == TiaType::Bool){
+            while(j < end && layout[j].type == TiaType::Bool && bit_of(j) == bit_of(j - 1) + 1) ++j;
+            if(j - i >= 2 && (bit_of(j - 1) / 8) < buffer.size()){
+                _decode_bits(i,j - i,buffer);
+                i = j;
+                continue;
+            }
+        }
+        else if(tia::has_array_reader(rec.type))
+            while(j < end && layout[j].type == rec.type && layout[j].offset == layout[j - 1].offset + rec.len) ++j;
+
+        const size_t n = j - i;
+        if(n < 2 || rec.type == TiaType::Bool || rec.offset + n * rec.len > buffer.size()){
+            _decode(rec,buffer,true);
+            ++i;
+            continue;
+        }
 
+        run_values.resize(n);
+        tia::read_array(rec.type, buffer.data() + rec.offset, n, run_values.data());
+        for(size_t k = 0; k < n; ++k){
+            BASE* leaf = leaves[layout[i + k].id];
+            leaf->set_value(std::move(run_values[k]));
+            changed.push_back(leaf);
+        }
+        i = j;
+    }
+}
 
+/// \brief Decodes the Bool records [first, first + count), which lie on consecutive bits.
+/// \details The run is read 56 bits at a time (tia::load_bits) and stored into bool_bits
+/// with a shift and a mask, instead of one byte read and bit test per leaf.
+void DB::_decode_bits(size_t first,size_t count,const std::vector<unsigned char>& buffer)
+{
+    const size_t src = size_t(layout[first].offset) * 8 + layout[first].bit;
+    for(size_t done = 0; done < count; ){
+        const size_t n = std::min<size_t>(56, count - done);
+        const std::uint64_t bits = tia::load_bits(buffer.data(), buffer.size(), src + done, n);
+
+        // Records of a run have consecutive ids, so the bits land in at most two words.
+        const size_t dst = first + done, shift = dst % 64;
+        const std::uint64_t mask = (std::uint64_t(1) << n) - 1;
+        std::uint64_t& lo = bool_bits[dst / 64];
+        lo = (lo & ~(mask << shift)) | (bits << shift);
+        if(shift + n > 64){
+            std::uint64_t& hi = bool_bits[dst / 64 + 1];
+            hi = (hi & ~(mask >> (64 - shift))) | (bits >> (64 - shift));
+        }
 
+        for(size_t k = 0; k < n; ++k){
+            BASE* leaf = leaves[dst + k];
+            leaf->set_value(((bits >> k) & 1) != 0);
+            changed.push_back(leaf);
+        }
+        done += n;
+    }
+}
+
+/// \brief Bytes compared at once when looking for changed regions.
+static constexpr size_t delta_chunk = 64;
+
+/// \brief Flags the chunks of \p buffer that differ from prev_buffer (same size expected).
+/// \return True if at least one chunk differs.
+bool DB::_mark_dirty_chunks(const std::vector<unsigned char>& buffer)
+{
+    size_t n = buffer.size();
+    dirty_chunks.assign((n + delta_chunk - 1) / delta_chunk, 0);
+
+    bool any = false;
+    for(size_t c = 0, pos = 0; pos < n; ++c, pos += delta_chunk){
+        size_t len = std::min(delta_chunk, n - pos);
+        if(std::memcmp(buffer.data() + pos, prev_buffer.data() + pos, len) != 0){
+            dirty_chunks[c] = 1;
+            any = true;
+        }
+    }
+    return any;
+}
+
+/// \brief True if the bytes (or the bit, for bools) of \p rec differ from prev_buffer.
+/// \note \p rec must lie inside the buffer.
+bool DB::_leaf_changed(const LeafRecord& rec,const std::vector<unsigned char>& buffer)const
+{
+    size_t start = rec.offset;
+    size_t len = std::max<size_t>(rec.len,1);
+
+    bool dirty = false;
+    for(size_t c = start / delta_chunk; c <= (start + len - 1) / delta_chunk && !dirty; ++c)
+        dirty = dirty_chunks[c] != 0;
+    if(!dirty) return false;
+
+    if(rec.type == TiaType::Bool){
+        unsigned char mask = static_cast<unsigned char>(1u << rec.bit);
+        return ((buffer[start] ^ prev_buffer[start]) & mask) != 0;
+    }
+    return std::memcmp(buffer.data() + start, prev_buffer.data() + start, len) != 0;
+}
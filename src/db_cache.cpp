@@ -0,0 +1,459 @@
+#include <db_cache.hpp>
+#include <classes.hpp>
+#include <fstream>
+#include <thread>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+/* ---------------- Memory mapped file ---------------- */
+
+#ifdef _WIN32
+
+/// \brief Maps \p path read-only; is_open() is false on failure.
+MappedFile::MappedFile(const std::string& path)
+{
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return;
+    file = f;
+
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(f, &sz)) return;
+    len = static_cast<std::size_t>(sz.QuadPart);
+    if (len == 0) { open = true; return; }
+
+    HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m == nullptr) return;
+    mapping = m;
+
+    ptr = static_cast<const unsigned char*>(MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0));
+    open = ptr != nullptr;
+}
+
+/// \brief Unmaps and closes the file.
+MappedFile::~MappedFile()
+{
+    if (ptr) UnmapViewOfFile(ptr);
+    if (mapping) CloseHandle(static_cast<HANDLE>(mapping));
+    if (file) CloseHandle(static_cast<HANDLE>(file));
+}
+
+#else
+
+/// \brief Maps \p path read-only; is_open() is false on failure.
+MappedFile::MappedFile(const std::string& path)
+{
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) return;
+    len = static_cast<std::size_t>(st.st_size);
+    if (len == 0) { open = true; return; }
+
+    void* p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) return;
+    ptr = static_cast<const unsigned char*>(p);
+    open = true;
+}
+
+/// \brief Unmaps and closes the file.
+MappedFile::~MappedFile()
+{
+    if (ptr) munmap(const_cast<unsigned char*>(ptr), len);
+    if (fd >= 0) ::close(fd);
+}
+
+#endif
+
+/* ---------------- File format ---------------- */
+
+static constexpr char cache_magic[4] = {'D','B','C','1'};
+
+/// \brief Fixed part at the start of a cache file.
+struct CacheHeader
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t source_hash;
+    std::uint32_t string_count;
+    std::uint32_t udt_count;
+    std::uint32_t node_count;
+    std::int32_t max_byte;
+    std::int32_t max_bit;
+};
+
+/// \brief One element of the tree. \c kind is the VariantElement index; \c a/\c b hold the
+/// array bounds or element index/max index, \c byte/\c bit the offset of a leaf.
+struct CacheNode
+{
+    std::uint8_t kind;
+    std::uint32_t name;
+    std::uint32_t type;
+    std::int32_t a;
+    std::int32_t b;
+    std::int32_t byte;
+    std::int32_t bit;
+    std::uint32_t childs;
+};
+
+/// \brief Serializes the tree into a byte vector, strings deduplicated.
+class CacheWriter
+{
+    private:
+        std::vector<unsigned char> strings;
+        std::vector<unsigned char> nodes;
+        std::unordered_map<std::string,std::uint32_t> ids;
+
+        template<typename T>
+        static void put(std::vector<unsigned char>& out,const T& v)
+        {
+            const auto* p = reinterpret_cast<const unsigned char*>(&v);
+            out.insert(out.end(), p, p + sizeof(T));
+        }
+
+    public:
+        std::uint32_t node_count = 0;
+
+        std::uint32_t intern(const std::string& s)
+        {
+            auto [it, added] = ids.emplace(s, static_cast<std::uint32_t>(ids.size()));
+            if (added) {
+                put(strings, static_cast<std::uint32_t>(s.size()));
+                strings.insert(strings.end(), s.begin(), s.end());
+            }
+            return it->second;
+        }
+
+        void count(std::uint32_t n) { put(nodes, n); }
+
+        void node(const VariantElement& el)
+        {
+            CacheNode n{};
+            n.kind = static_cast<std::uint8_t>(el.index());
+            std::vector<VariantElement> childs;
+
+            std::visit([&](auto&& ptr) {
+                using T = std::decay_t<decltype(*ptr)>;
+                n.name = intern(ptr->get_name());
+                n.type = intern(ptr->get_type());
+
+                if constexpr (std::is_base_of_v<BASE, T>) {
+                    n.byte = ptr->get_offset().first;
+                    n.bit = ptr->get_offset().second;
+                }
+                else if constexpr (std::is_same_v<T, UDT_ARRAY>) {
+                    // Only the prototype is stored, elements are materialized on demand.
+                    n.byte = ptr->get_base().first;
+                    n.bit = ptr->get_base().second;
+                    if (ptr->get_prototype() != nullptr) childs.push_back(ptr->get_prototype());
+                }
+                else {
+                    childs = ptr->get_childs();
+                }
+                if constexpr (std::is_same_v<T, STD_ARR_ELEM> || std::is_same_v<T, UDT_ARR_ELEM> ||
+                              std::is_same_v<T, STRUCT_ARRAY_EL>) {
+                    n.a = ptr->get_index();
+                    n.b = ptr->get_max_index();
+                }
+                else if constexpr (std::is_same_v<T, STD_ARRAY> || std::is_same_v<T, UDT_ARRAY> ||
+                                   std::is_same_v<T, STRUCT_ARRAY>) {
+                    n.a = ptr->get_start();
+                    n.b = ptr->get_end();
+                }
+            }, el);
+
+            n.childs = static_cast<std::uint32_t>(childs.size());
+            put(nodes, n);
+            ++node_count;
+            for (const auto& ch : childs) node(ch);
+        }
+
+        std::vector<unsigned char> finish(CacheHeader h)
+        {
+            h.string_count = static_cast<std::uint32_t>(ids.size());
+            h.node_count = node_count;
+
+            std::vector<unsigned char> out;
+            out.reserve(sizeof(h) + strings.size() + nodes.size());
+            put(out, h);
+            out.insert(out.end(), strings.begin(), strings.end());
+            out.insert(out.end(), nodes.begin(), nodes.end());
+            return out;
+        }
+};
+
+/// \brief Rebuilds the tree from a mapped cache; every read is bounds checked.
+class CacheReader
+{
+    private:
+        const unsigned char* cur;
+        const unsigned char* end;
+        std::vector<std::string> strings;
+        std::uint32_t nodes_left = 0;
+
+        template<typename T>
+        bool get(T& v)
+        {
+            if (static_cast<std::size_t>(end - cur) < sizeof(T)) return false;
+            std::memcpy(&v, cur, sizeof(T));
+            cur += sizeof(T);
+            return true;
+        }
+
+        bool str(std::uint32_t id,std::string& out) const
+        {
+            if (id >= strings.size()) return false;
+            out = strings[id];
+            return true;
+        }
+
+        /// \brief Creates the element of a record; children are attached by node().
+        static VariantElement make(const CacheNode& n,const std::string& name,const std::string& type,
+                                   std::shared_ptr<BASE_CONTAINER> par)
+        {
+            std::string nm = name;
+            switch (n.kind) {
+                case 0: {
+                    auto el = arena::make<STD_SINGLE>(name, type, par);
+                    el->set_layout({n.byte, n.bit});
+                    return el;
+                }
+                case 1: {
+                    auto el = arena::make<STD_ARR_ELEM>(name, type, n.a, n.b, par);
+                    el->set_layout({n.byte, n.bit});
+                    return el;
+                }
+                case 2: return arena::make<STD_ARRAY>(name, type, n.a, n.b, par);
+                case 3: return arena::make<UDT_SINGLE>(name, type);
+                case 4: {
+                    auto el = arena::make<UDT_ARR_ELEM>();
+                    el->set_name(name);
+                    el->set_type(type);
+                    el->set_index(n.a);
+                    el->set_max_index(n.b);
+                    return el;
+                }
+                case 5: {
+                    auto el = arena::make<UDT_ARRAY>();
+                    el->set_name(name);
+                    el->set_type(type);
+                    el->set_start(n.a);
+                    el->set_end(n.b);
+                    return el;
+                }
+                case 6: return arena::make<STRUCT_SINGLE>(nm, type);
+                case 7: return arena::make<STRUCT_ARRAY_EL>(nm, n.a, n.b, type);
+                case 8: {
+                    auto el = arena::make<STRUCT_ARRAY>(nm, type);
+                    el->set_index(n.a);
+                    el->set_max_index(n.b);
+                    return el;
+                }
+            }
+            throw std::logic_error("Invalid cache node kind");
+        }
+
+    public:
+        CacheReader(const unsigned char* data,std::size_t size)
+            : cur(data), end(data + size) {}
+
+        bool header(CacheHeader& h)
+        {
+            if (!get(h)) return false;
+            nodes_left = h.node_count;
+            strings.reserve(h.string_count);
+            for (std::uint32_t i = 0; i < h.string_count; ++i) {
+                std::uint32_t n;
+                if (!get(n) || static_cast<std::size_t>(end - cur) < n) return false;
+                strings.emplace_back(reinterpret_cast<const char*>(cur), n);
+                cur += n;
+            }
+            return true;
+        }
+
+        bool count(std::uint32_t& n) { return get(n); }
+
+        bool name(std::string& out)
+        {
+            std::uint32_t id;
+            return get(id) && str(id, out);
+        }
+
+        /// \brief Reads one node and its subtree, parented to \p par.
+        bool node(std::shared_ptr<BASE_CONTAINER> par,VariantElement& out)
+        {
+            CacheNode n;
+            std::string name, type;
+            if (nodes_left == 0 || !get(n) || n.kind >= std::variant_size_v<VariantElement> ||
+                !str(n.name, name) || !str(n.type, type)) return false;
+            --nodes_left;
+
+            out = make(n, name, type, par);
+
+            bool ok = true;
+            std::visit([&](auto&& ptr) {
+                using T = std::decay_t<decltype(*ptr)>;
+                ptr->set_parent(par);
+                if constexpr (std::is_same_v<T, UDT_ARRAY>) {
+                    VariantElement proto;
+                    ok = n.childs <= 1;
+                    if (ok && n.childs == 1) {
+                        ok = node(ptr, proto) && std::holds_alternative<std::shared_ptr<UDT_SINGLE>>(proto);
+                        if (ok) ptr->set_prototype(std::get<std::shared_ptr<UDT_SINGLE>>(proto));
+                    }
+                    if (ok) ptr->set_layout({n.byte, n.bit});
+                }
+                else if constexpr (std::is_base_of_v<BASE_CONTAINER, T>) {
+                    for (std::uint32_t i = 0; i < n.childs && ok; ++i) {
+                        VariantElement ch;
+                        ok = node(ptr, ch);
+                        if (ok) ptr->insert_child(ch);
+                    }
+                }
+                else ok = n.childs == 0;
+            }, out);
+            return ok;
+        }
+
+        bool at_end() const { return cur == end && nodes_left == 0; }
+};
+
+/* ---------------- Public API ---------------- */
+
+/// \brief Cache file used for \p source_path ("dir/foo.db" -> "dir/foo.dbc").
+std::string db_cache::cache_path(const std::string& source_path)
+{
+    return std::filesystem::path(source_path).replace_extension(extension).string();
+}
+
+/// \brief 64-bit FNV-1a hash of the file content, std::nullopt if it cannot be read.
+std::optional<std::uint64_t> db_cache::hash_file(const std::string& path)
+{
+    MappedFile f(path);
+    if (!f.is_open()) return std::nullopt;
+    return hash_bytes(f.data(), f.size());
+}
+
+/// \brief 64-bit FNV-1a hash of \p len bytes at \p p.
+std::uint64_t db_cache::hash_bytes(const unsigned char* p,std::size_t len)
+{
+    std::uint64_t h = 14695981039346656037ull;
+    for (std::size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+/// \brief Writes the laid-out \p db and its UDT registry to \p path.
+/// \details Written to a per-thread temporary file first and renamed, so a reader never sees
+/// half a file and concurrent writers do not clash.
+bool db_cache::save(const std::string& path,std::uint64_t source_hash,const std::shared_ptr<DB>& db,const UdtRawMap& udts)
+{
+    if (db == nullptr) return false;
+
+    CacheWriter w;
+    CacheHeader h{};
+    std::memcpy(h.magic, cache_magic, sizeof(h.magic));
+    h.version = parser_version;
+    h.source_hash = source_hash;
+    h.udt_count = static_cast<std::uint32_t>(udts.size());
+    h.max_byte = db->get_max_offset().first;
+    h.max_bit = db->get_max_offset().second;
+
+    std::uint32_t db_name = w.intern(db->get_name());
+    w.count(db_name);
+    for (const auto& [name, udt] : udts) {
+        w.count(w.intern(name));
+        w.count(w.intern(udt->get_name()));
+        w.count(static_cast<std::uint32_t>(udt->get_childs().size()));
+        for (const auto& ch : udt->get_childs()) w.node(ch);
+    }
+    auto childs = db->get_childs();
+    w.count(static_cast<std::uint32_t>(childs.size()));
+    for (const auto& ch : childs) w.node(ch);
+
+    std::vector<unsigned char> bytes = w.finish(h);
+
+    std::string tmp = path + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+            std::cerr << "Cannot write DB cache " << tmp << "\n";
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::cerr << "Cannot write DB cache " << path << ": " << ec.message() << "\n";
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+/// \brief Loads \p db and \p udts from the cache at \p path, the nodes in a new ElementArena
+/// interning their names in \p strings.
+/// \return false (outputs untouched) if the cache is missing, stale or malformed.
+bool db_cache::load(const std::string& path,std::uint64_t source_hash,std::shared_ptr<DB>& db,UdtRawMap& udts,std::shared_ptr<StringPool> strings)
+{
+    MappedFile f(path);
+    if (!f.is_open() || f.size() < sizeof(CacheHeader)) return false;
+
+    CacheReader r(f.data(), f.size());
+    CacheHeader h;
+    if (!r.header(h) || std::memcmp(h.magic, cache_magic, sizeof(h.magic)) != 0 ||
+        h.version != parser_version || h.source_hash != source_hash) return false;
+
+    try {
+        auto tree = std::make_shared<ElementArena>(std::move(strings));
+        arena::Scope scope(tree);
+
+        std::string db_name;
+        if (!r.name(db_name)) return false;
+
+        UdtRawMap new_udts;
+        for (std::uint32_t u = 0; u < h.udt_count; ++u) {
+            std::string key, name;
+            std::uint32_t n;
+            if (!r.name(key) || !r.name(name) || !r.count(n)) return false;
+            auto udt = arena::make<UDT_RAW>(name);
+            for (std::uint32_t i = 0; i < n; ++i) {
+                VariantElement ch;
+                if (!r.node(nullptr, ch)) return false;
+                udt->insert_child(ch);
+            }
+            new_udts[key] = udt;
+        }
+
+        auto new_db = arena::make<DB>(db_name);
+        std::uint32_t n;
+        if (!r.count(n)) return false;
+        for (std::uint32_t i = 0; i < n; ++i) {
+            VariantElement ch;
+            if (!r.node(new_db, ch)) return false;
+            new_db->insert_child(ch);
+        }
+        if (!r.at_end()) return false;
+
+        new_db->set_arena(tree);
+        new_db->set_max_offset({h.max_byte, h.max_bit});
+        new_db->_build_layout();
+
+        db = std::move(new_db);
+        udts = std::move(new_udts);
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Invalid DB cache " << path << ": " << e.what() << "\n";
+        return false;
+    }
+}
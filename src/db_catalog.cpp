@@ -0,0 +1,183 @@
+#include <db_catalog.hpp>
+#include <db_cache.hpp>
+#include <udt_library.hpp>
+#include <classes.hpp>
+
+using namespace std::chrono;
+
+/// \brief Milliseconds between two time points.
+static double span_ms(steady_clock::time_point from,steady_clock::time_point to)
+{
+    return duration<double,std::milli>(to - from).count();
+}
+
+/// \brief Builds the laid-out DB of one file: from its cache when the source hash matches,
+/// otherwise with the grammar parser, UDTs already in \p library not being parsed again
+/// (and the cache is rewritten). Names are interned in \p strings.
+/// \details Safe to call from several threads at once, each call uses its own ParserState.
+CatalogEntry db_catalog::load_file(const std::string& path,const std::string& name,UdtLibrary& library,std::shared_ptr<StringPool> strings)
+{
+    CatalogEntry entry;
+    entry.path = path;
+    entry.name = name;
+
+    auto t0 = steady_clock::now();
+    try {
+        auto hash = db_cache::hash_file(path);
+        if (!hash.has_value()) throw std::runtime_error("cannot read file");
+        entry.hash = hash.value();
+
+        std::string cache = db_cache::cache_path(path);
+        entry.from_cache = db_cache::load(cache, entry.hash, entry.db, entry.udts, strings);
+        if (!entry.from_cache) {
+            entry.db = udt_library::parse(path, name, library, entry.udts, strings);
+            db_cache::save(cache, entry.hash, entry.db, entry.udts);
+        }
+    }
+    catch (const std::exception& e) {
+        entry.db = nullptr;
+        entry.error = e.what();
+        std::cerr << "Cannot load " << path << ": " << e.what() << "\n";
+    }
+    entry.load_ms = span_ms(t0, steady_clock::now());
+    return entry;
+}
+
+/// \brief Appends every .db file below \p dir to \p out.
+void db_catalog::collect_db_files(const _folder_& dir,std::vector<_file_>& out)
+{
+    for (const auto& el : dir.elements) {
+        if (std::holds_alternative<_folder_>(el))
+            collect_db_files(std::get<_folder_>(el), out);
+        else if (std::filesystem::path(std::get<_file_>(el).name).extension() == ".db")
+            out.push_back(std::get<_file_>(el));
+    }
+}
+
+/// \brief Stops the indexing and joins the workers.
+DbCatalog::~DbCatalog()
+{
+    cancel = true;
+    _join();
+}
+
+/// \brief Starts loading every .db file below \p root on \p threads workers
+/// (0 = one per hardware thread). A running indexing is cancelled first and the entries,
+/// UDT definitions and string pool of the previous project are dropped.
+void DbCatalog::index(const _folder_& root,unsigned threads)
+{
+    cancel = true;
+    _join();
+
+    files.clear();
+    udt_library.clear();
+    strings = std::make_shared<StringPool>();
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        entries.clear();
+    }
+    db_catalog::collect_db_files(root, files);
+    next = 0;
+    done = 0;
+    failed = 0;
+    cancel = false;
+    started = steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        elapsed_ms = 0.0;
+    }
+    if (files.empty()) return;
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, files.size()));
+    for (unsigned i = 0; i < threads; ++i)
+        workers.emplace_back(&DbCatalog::_work, this);
+}
+
+/// \brief Loads one file now (on the calling thread) and publishes it.
+std::shared_ptr<const CatalogEntry> DbCatalog::load(const std::string& path,const std::string& name)
+{
+    _publish(db_catalog::load_file(path, name, udt_library, strings));
+    return find(path);
+}
+
+/// \brief Entry of \p path, nullptr if it was not loaded (yet).
+std::shared_ptr<const CatalogEntry> DbCatalog::find(const std::string& path)const
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    auto it = entries.find(path);
+    return it == entries.end() ? nullptr : it->second;
+}
+
+/// \brief All loaded entries, ordered by path.
+std::vector<std::shared_ptr<const CatalogEntry>> DbCatalog::get_entries()const
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    std::vector<std::shared_ptr<const CatalogEntry>> out;
+    out.reserve(entries.size());
+    for (const auto& [path, e] : entries) out.push_back(e);
+    return out;
+}
+
+/// \brief Files done/failed so far and the elapsed (or total) indexing time.
+CatalogProgress DbCatalog::get_progress()const
+{
+    CatalogProgress p;
+    p.total = files.size();
+    p.done = done;
+    p.failed = failed;
+    p.running = p.done < p.total && !cancel;
+
+    std::lock_guard<std::mutex> lk(mtx);
+    p.elapsed_ms = p.running ? span_ms(started, steady_clock::now()) : elapsed_ms;
+    return p;
+}
+
+/// \brief Counters of the UDT definitions shared between the files.
+UdtLibraryStats DbCatalog::get_udt_stats()const{return udt_library.get_stats();}
+
+/// \brief Counters of the string pool of the project.
+StringPoolStats DbCatalog::get_string_stats()const{return strings->get_stats();}
+
+/// \brief Worker: takes the next file until all are taken or the indexing is cancelled.
+void DbCatalog::_work()
+{
+    for (std::size_t i = next++; i < files.size() && !cancel; i = next++) {
+        CatalogEntry entry = db_catalog::load_file(files[i].path, files[i].name, udt_library, strings);
+        if (!entry.error.empty()) ++failed;
+        _publish(std::move(entry));
+
+        if (++done == files.size()) {
+            double total_ms = span_ms(started, steady_clock::now());
+            {
+                std::lock_guard<std::mutex> lk(mtx);
+                elapsed_ms = total_ms;
+            }
+            auto udt = udt_library.get_stats();
+            std::cout << "Indexed " << files.size() << " DBs in " << total_ms << " ms ("
+                      << failed << " failed)\n"
+                      << "UDT library: " << udt.unique << " parsed in " << udt.parse_ms << " ms, "
+                      << udt.reused << " reused (" << udt.saved_ms << " ms, "
+                      << udt.saved_bytes / 1024 << " KiB saved)\n";
+            auto pool = strings->get_stats();
+            std::cout << "String pool: " << pool.strings << " strings, " << pool.bytes / 1024
+                      << " KiB, " << pool.hits << " shared\n";
+        }
+    }
+}
+
+/// \brief Joins the workers of the previous indexing.
+void DbCatalog::_join()
+{
+    for (auto& w : workers)
+        if (w.joinable()) w.join();
+    workers.clear();
+}
+
+/// \brief Makes \p entry visible to find().
+void DbCatalog::_publish(CatalogEntry entry)
+{
+    auto e = std::make_shared<const CatalogEntry>(std::move(entry));
+    std::lock_guard<std::mutex> lk(mtx);
+    entries[e->path] = e;
+}
@@ -0,0 +1,114 @@
+#include <filter_worker.hpp>
+
+using namespace std::chrono;
+
+/// \brief Query for filter \p f on \p db. GUI thread only.
+/// \details The first query of a DB captures its SearchIndex (see SearchIndex::of()); the
+/// worker builds it. Value and Bool filters also copy the current leaf values.
+std::shared_ptr<Filter::FilterQuery> Filter::FilterQuery::capture(const std::shared_ptr<DB>& db,const filterElem& f)
+{
+    auto q = std::make_shared<FilterQuery>();
+    q->filter = f;
+    q->db = db;
+    q->index = SearchIndex::of(db);
+    if (f.value_in) q->values = q->index->capture_values(*db);
+    if (f.bool_el) q->bools = q->index->capture_bools(*db);
+    return q;
+}
+
+/// \brief Creates the (idle) worker thread.
+Filter::FilterWorker::FilterWorker()
+{
+    worker = std::thread(&FilterWorker::_run, this);
+}
+
+/// \brief Stops and joins the worker thread.
+Filter::FilterWorker::~FilterWorker()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        stop_requested = true;
+    }
+    cv.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+/// \brief Queues \p q for evaluation; a query still queued or running is dropped.
+void Filter::FilterWorker::submit(std::shared_ptr<FilterQuery> q)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        q->seq = latest.load(std::memory_order_relaxed) + 1;
+        latest.store(q->seq, std::memory_order_release);
+        pending = std::move(q);
+    }
+    cv.notify_all();
+}
+
+/// \brief Drops the queued and running queries; their results are never fetched.
+void Filter::FilterWorker::cancel()
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    latest.fetch_add(1, std::memory_order_release);
+    pending.reset();
+}
+
+/// \brief Newest result of the newest query, nullptr if none arrived since the last call.
+/// GUI thread only.
+std::shared_ptr<const Filter::FilterResult> Filter::FilterWorker::fetch()
+{
+    const auto* r = handoff.fetch();
+    if (r == nullptr || *r == nullptr) return nullptr;
+    if ((*r)->query->seq != latest.load(std::memory_order_acquire)) return nullptr;
+    return *r;
+}
+
+/// \brief Writes the bitmap of \p r to the tree. GUI thread only.
+/// \param previous Result applied last, if any: only the nodes whose bit differs are set.
+void Filter::FilterWorker::apply(const FilterResult& r,const FilterResult* previous)
+{
+    const bool same_index = previous != nullptr && previous->query->index == r.query->index;
+    r.query->index->apply(r.vis, same_index ? &previous->vis : nullptr);
+}
+
+/// \brief Worker loop: evaluates the newest query and publishes its result.
+void Filter::FilterWorker::_run()
+{
+    std::unique_lock<std::mutex> lk(mtx);
+    while (!stop_requested)
+    {
+        if (pending == nullptr) {
+            cv.wait(lk);
+            continue;
+        }
+
+        std::shared_ptr<const FilterQuery> q = std::move(pending);
+        pending.reset();
+        lk.unlock();
+
+        auto r = std::make_shared<FilterResult>();
+        if (_evaluate(q, *r)) {
+            handoff.write_slot() = std::move(r);
+            handoff.publish();
+        }
+
+        lk.lock();
+    }
+}
+
+/// \brief Builds the index of \p query if needed and evaluates the filter on it.
+/// \return false if a newer query was submitted meanwhile.
+bool Filter::FilterWorker::_evaluate(const std::shared_ptr<const FilterQuery>& query,FilterResult& out)
+{
+    const auto start = steady_clock::now();
+    const FilterQuery& q = *query;
+
+    q.index->build();
+    out.query = query;
+    bool done = q.index->evaluate(q.filter, q.filter.value_in ? &q.values : nullptr,
+        q.filter.bool_el ? &q.bools : nullptr, out.vis,
+        [this, &q] { return latest.load(std::memory_order_acquire) != q.seq; });
+
+    out.eval_ms = duration<double,std::milli>(steady_clock::now() - start).count();
+    return done;
+}
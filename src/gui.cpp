@@ -1,6 +1,8 @@
 #include <gui.hpp>
 #include <managers.hpp>
 #include <classes.hpp>
+#include <tree_walk.hpp>
+#include <type_readers.hpp>
 
 /// \brief Main GUI controller: owns top bar, body, comm manager, and filter bar.
 /// \details Initializes all UI components and the communication layer.
@@ -22,6 +24,8 @@ void MainGUIController::draw()
 
     cursor = std::make_unique<DrawingInfo>(work_pos,work_size);
 
+    CommMan->update();
+
     const float margin = 20.0f;                    
     const float x      = work_pos.x + margin;
     float       y      = work_pos.y + margin;
@@ -130,6 +134,88 @@ void ConnectionBar::DrawDbNr()
 }
 
 
+/// \brief Draws the polling cycle picker and the Start/Stop button for cyclic reads.
+/// \details Reads run on the CommManager poller thread; results are applied once per frame.
+void ConnectionBar::DrawPollCycle()
+{
+    static const std::array<std::pair<const char*,int>,4> cycles {{
+        {"50 ms",50}, {"100 ms",100}, {"250 ms",250}, {"1 s",1000}
+    }};
+    int current = this_controller->CommMan->get_poll_cycle();
+
+    const char* preview = "Cycle";
+    for (auto& c : cycles) if (c.second == current) preview = c.first;
+
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::BeginCombo("##Cycle", preview)) {
+        for (auto& c : cycles) {
+            if (ImGui::Selectable(c.first, c.second == current))
+                this_controller->CommMan->set_poll_cycle(c.second);
+        }
+        ImGui::EndCombo();
+    }
+
+    ImGui::SameLine();
+    if (this_controller->CommMan->is_polling()) {
+        if (ImGui::Button("Stop")) this_controller->CommMan->stop_polling();
+    }
+    else {
+        if (ImGui::Button("Start")) this_controller->CommMan->start_polling();
+    }
+
+    ImGui::SameLine();
+    DrawSchedule();
+}
+
+/// \brief Draws the multi-PLC acquisition controls and the per-PLC cycle table (as tooltip).
+/// \details “Acquire All” schedules the current DB on every discovered PLC with the selected cycle;
+/// selecting one of them in the device combo shows its latest image.
+void ConnectionBar::DrawSchedule()
+{
+    auto& scheduler = this_controller->CommMan->Scheduler;
+    if (scheduler.size() == 0) {
+        if (!this_controller->CommMan->NetMan.get_devices()->empty() && ImGui::Button("Acquire All"))
+            this_controller->CommMan->schedule_all_devices();
+        return;
+    }
+
+    if (ImGui::Button("Stop All")) {
+        this_controller->CommMan->clear_schedule();
+        return;
+    }
+    ImGui::SameLine();
+    ImGui::Text("%zu PLC", scheduler.size());
+    if (!ImGui::IsItemHovered()) return;
+
+    ImGui::BeginTooltip();
+    const auto& images = this_controller->CommMan->get_plc_images();
+    const auto now = std::chrono::steady_clock::now();
+    if (ImGui::BeginTable("##Schedule", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("PLC");
+        ImGui::TableSetupColumn("Requested");
+        ImGui::TableSetupColumn("Achieved");
+        ImGui::TableSetupColumn("Overruns");
+        ImGui::TableSetupColumn("Errors");
+        ImGui::TableSetupColumn("Image");
+        ImGui::TableHeadersRow();
+        for (auto& st : scheduler.get_stats()) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(st.key.to_string().c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%.0f ms", st.requested_ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.1f ms", st.achieved_ms);
+            ImGui::TableNextColumn(); ImGui::Text("%lu", st.overruns);
+            ImGui::TableNextColumn(); ImGui::Text("%lu", st.errors);
+            ImGui::TableNextColumn();
+            auto it = images.find(st.key);
+            if (it == images.end() || it->second.dbs.empty()) ImGui::TextUnformatted("-");
+            else ImGui::Text("%zu B, %.0f ms old", it->second.dbs.front().buffer.size(),
+                             std::chrono::duration<double,std::milli>(now - it->second.dbs.front().stamp).count());
+        }
+        ImGui::EndTable();
+    }
+    ImGui::EndTooltip();
+}
+
 /// \brief Renders the full connection bar: device, DB number, adapter, and buttons.
 /// \details Includes “Refresh Devices” and “Get Data” actions.
 void ConnectionBar::Draw() {
@@ -153,7 +239,9 @@ void ConnectionBar::Draw() {
     {
         ImGui::SameLine();
         ImGui::SetNextItemWidth(200);
-        if (ImGui::Button("Refresh Devices")) {
+        if (this_controller->CommMan->NetMan.is_scanning())
+            ImGui::TextUnformatted("Scanning...");
+        else if (ImGui::Button("Refresh Devices")) {
             this_controller->CommMan->NetMan.scan_network();
         }
     }
@@ -163,10 +251,26 @@ void ConnectionBar::Draw() {
     if( this_controller->CommMan->NetMan.get_ip().has_value() &&
         this_controller->CommMan->DataMan.get_db()!=nullptr )
         {
-            if (ImGui::Button("Get Data")) 
+            if (ImGui::Button("Get Data"))
                 this_controller->CommMan->get_plc_data();
-            
+
+            ImGui::SameLine();
+            DrawPollCycle();
+        }
+
+    auto stats = this_controller->CommMan->NetMan.get_connection_stats();
+    if (stats.has_value() && stats->connects > 0)
+    {
+        ImGui::SameLine();
+        ImGui::Text("Handshake %.1f ms | Read %.1f ms (avg %.1f) | %d B in %d req | PDU %d",
+            stats->handshake_ms, stats->last_read_ms, stats->avg_read_ms,
+            stats->last_read_bytes, stats->last_read_requests, stats->pdu_length);
+        if (this_controller->CommMan->is_polling())
+        {
+            ImGui::SameLine();
+            ImGui::Text("| Cycle %.1f ms", this_controller->CommMan->get_last_cycle());
         }
+    }
 
 };
 
@@ -179,13 +283,15 @@ FilterBar::FilterBar(MainGUIController* controller)
 void FilterBar::activate(){ active = !active; }
 
 /// \brief Draws the filter UI (mode picker, inputs) and applies the filter.
-/// \details When disabled, clears the filter; otherwise updates f_el and triggers apply.
+/// \details When disabled, clears the filter; otherwise updates f_el and, only if it was
+/// switched on or an input changed, queues a new evaluation.
 void FilterBar::draw()
 {
     auto* f_el = this_controller->CommMan->FilMan.get_filter();
+    bool changed = false;
     
     const char* btn = active ? "Unfilter" : "Filter";
-    if (ImGui::Button(btn)) activate();
+    if (ImGui::Button(btn)) { activate(); changed = true; }
 
     ImGui::SameLine();
     
@@ -199,12 +305,13 @@ void FilterBar::draw()
 
     ImGui::SetNextItemWidth(140);
     if (ImGui::InputText("Value", value_buf.data(), (int)value_buf.size())) {
+        changed = true;
         std::string v = value_buf.data();
         if(v.find("/bool:") != v.npos) v = v.substr(v.find(":")+1,v.size());
 
         Value v_;
         v_ = translate::parse_type(v);
-        if (std::holds_alternative<std::string>(v_) && v != "" || std::holds_alternative<int>(v_))
+        if (!std::holds_alternative<bool>(v_) && v != "")
         {
             f_el->value_in  = v_;
             f_el->bool_el.reset();
@@ -223,6 +330,7 @@ void FilterBar::draw()
 
     ImGui::SetNextItemWidth(140);
     if (ImGui::InputText("Name", name_buf.data(), (int)name_buf.size())) {
+        changed = true;
         std::string n = name_buf.data();
         if(n == "") f_el->name.reset();
         else f_el->name  = n;
@@ -232,12 +340,13 @@ void FilterBar::draw()
 
     ImGui::SetNextItemWidth(140);
     if (ImGui::InputText("Comment", comment_buf.data(), (int)comment_buf.size())) {
+        changed = true;
         std::string c = comment_buf.data();
         if(c == "") f_el->comment.reset();
         else f_el->comment  = c;
     }
 
-    this_controller->CommMan->set_filter_mode();
+    if (changed) this_controller->CommMan->set_filter_mode();
 }
 
 /// \brief Main content body: explorer (projects/files) and DB viewer trees.
@@ -246,59 +355,145 @@ Body::Body(MainGUIController* main)
     :this_controller(main){};
 
 
-/// \brief Recursively draws a DB element (container or leaf) as an ImGui tree node.
-/// \param element Variant element to draw.
-/// \param depth_in Current recursion depth (incremented/decremented during traversal).
-void Body::Draw_node(const VariantElement& element,int& depth_in){
+/// \brief Flattens the visible tree of \p db into \c rows.
+/// \details Runs only when a node was opened or closed, a filter changed what is visible,
+/// array elements were materialized or another DB is shown; not every frame.
+void Body::_build_rows(const std::shared_ptr<DB>& db){
+    if (rows_db != db.get()) open_nodes.clear();
+    rows_db = db.get();
+    rows_tree_gen = class_utils::tree_generation();
+    rows_vis_gen = class_utils::vis_generation();
+    rows_dirty = false;
+
+    rows.clear();
+    _add_rows(db->get_childs().data(), db->get_childs().size(), 0);
+}
+
+/// \brief Appends the rows of \p count sibling elements from \p first and of their open
+/// subtrees, hidden (filtered out) elements skipped.
+void Body::_add_rows(const VariantElement* first,std::size_t count,int depth){
+    tree_walk::walk(first, count,
+    [&](const VariantElement& el) {
+        return std::visit([&](const auto& ptr) -> bool {
+            using T = std::decay_t<decltype(*ptr)>;
+            if (!ptr->get_vis()) return false;
+
+            if constexpr (std::is_base_of_v<BASE, T>) {
+                rows.push_back({el, TreeRow::Kind::Leaf, depth});
+                return false;
+            }
+            else {
+                rows.push_back({el, TreeRow::Kind::Container, depth});
+                if (open_nodes.count(ptr.get()) == 0) return false;
+
+                if constexpr (std::is_same_v<T, UDT_ARRAY>) {
+                    // One row per index; only the opened elements exist as nodes, a filter
+                    // hides the others through the array (see SearchIndex::apply()).
+                    for (int i = ptr->get_start(); i <= ptr->get_end(); ++i) {
+                        if (!ptr->get_element_vis(i)) continue;
+                        auto item = ptr->find_element(i);
+                        rows.push_back({el, TreeRow::Kind::ArrayElement, depth + 1, i});
+                        if (item != nullptr && open_nodes.count(item.get()) > 0)
+                            _add_rows(item->get_childs().data(), item->get_childs().size(), depth + 2);
+                    }
+                    return false;
+                }
+                ++depth;
+                return true;
+            }
+        }, el);
+    },
+    [&](const VariantElement&) { --depth; });
+}
+
+/// \brief Draws one row: a tree node for containers and array elements, the name and
+/// the value for leaves. Opening or closing a node marks the rows for a rebuild.
+/// \details Every drawn leaf is collected in \c shown.
+void Body::_draw_row(const TreeRow& row){
+    const ImGuiTreeNodeFlags node_flags = ImGuiTreeNodeFlags_Framed|ImGuiTreeNodeFlags_OpenOnDoubleClick|ImGuiTreeNodeFlags_OpenOnArrow|ImGuiTreeNodeFlags_NoTreePushOnOpen;
+
+    ImGui::SetCursorPosX(ImGui::GetCursorPosX() + row.depth * ImGui::GetStyle().IndentSpacing);
 
-    std::visit([&](auto&& ptr) {
+    std::visit([&](const auto& ptr) {
         using T = std::decay_t<decltype(*ptr)>;
-        std::string label = ptr->get_name() ;
-        
-        if constexpr (std::is_base_of_v<BASE_CONTAINER, T>) {
-            if(ptr->get_vis())
-                if (ImGui::TreeNodeEx(label.c_str(), ImGuiTreeNodeFlags_Framed|ImGuiTreeNodeFlags_OpenOnDoubleClick|ImGuiTreeNodeFlags_OpenOnArrow)) {
-                    ++depth_in;
-                    for (const auto& child : ptr->get_childs()) {
-                        if(ptr->get_vis())
-                            Draw_node(child, depth_in);
+        const std::string& label = ptr->get_name();
+        ImGui::PushID(ptr.get());
+
+        if constexpr (std::is_base_of_v<BASE, T>) {
+            shown.push_back(row.el);
+            ImGui::TreeNodeEx(label.c_str(), ImGuiTreeNodeFlags_Leaf|ImGuiTreeNodeFlags_NoTreePushOnOpen);
+            ImGui::SameLine();
+            ImGui::Text("%s: ", "Data");
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(300);
+
+            Value data=ptr->get_data();
+            std::visit([&](auto& val) {
+                using V = std::decay_t<decltype(val)>;
+                if constexpr (std::is_same_v<V, int>) {
+                    if (ImGui::InputScalar("##Data",ImGuiDataType_S32, &val)) {
+                        
+                    }
+                } 
+                else if constexpr (std::is_same_v<V, std::int64_t>) {
+                    ImGui::InputScalar("##Data",ImGuiDataType_S64, &val);
+                }
+                else if constexpr (std::is_same_v<V, std::uint64_t>) {
+                    ImGui::InputScalar("##Data",ImGuiDataType_U64, &val);
+                }
+                else if constexpr (std::is_same_v<V, float>) {
+                    ImGui::InputScalar("##Data",ImGuiDataType_Float, &val, nullptr, nullptr, "%.9g");
+                }
+                else if constexpr (std::is_same_v<V, double>) {
+                    ImGui::InputScalar("##Data",ImGuiDataType_Double, &val, nullptr, nullptr, "%.17g");
+                }
+                else if constexpr (std::is_same_v<V, TimeValue>) {
+                    ImGui::TextUnformatted(tia::to_string(val).c_str());
+                }
+                else if constexpr (std::is_same_v<V, bool>) {
+                    if (ImGui::Checkbox("##Data", &val)) {
+                        
+                    }
+                } 
+                else if constexpr (std::is_same_v<V, std::string>) {
+                    static char buffer[128];
+                    strncpy(buffer, val.c_str(), sizeof(buffer));
+                    if (ImGui::InputText("##Data", buffer, IM_ARRAYSIZE(buffer))) {
+                        
                     }
-                    --depth_in;
-                    ImGui::TreePop();
                 }
+            },data);
         }
-        else if constexpr (std::is_base_of_v<BASE, T>) {
-            if(ptr->get_vis())
-                if (ImGui::TreeNodeEx(label.c_str(),ImGuiTreeNodeFlags_Leaf| ImGuiTreeNodeFlags_DefaultOpen|ImGuiTreeNodeFlags_Framed|ImGuiTreeNodeFlags_OpenOnDoubleClick)) {
-                    Value data=ptr->get_data();
-                    std::string data_label  = "Data";
-                    ImGui::Text("%s: ", data_label.c_str());
-                    ImGui::SetNextItemWidth(300);
-                    ImGui::SameLine();
-                    std::visit([&](auto& val) {
-                        using V = std::decay_t<decltype(val)>;
-                        if constexpr (std::is_same_v<V, int>) {
-                            if (ImGui::InputScalar(("##"+data_label).c_str(),ImGuiDataType_S32, &val)) {
-                                
-                            }
-                        } 
-                        else if constexpr (std::is_same_v<V, bool>) {
-                            if (ImGui::Checkbox(("##"+data_label).c_str(), &val)) {
-                                
-                            }
-                        } 
-                        else if constexpr (std::is_same_v<V, std::string>) {
-                            static char buffer[128];
-                            strncpy(buffer, val.c_str(), sizeof(buffer));
-                            if (ImGui::InputText(("##"+data_label).c_str(), buffer, IM_ARRAYSIZE(buffer))) {
-                                
-                            }
-                        }
-                    },data);
-                    ImGui::TreePop();
+        else {
+            const void* key = ptr.get();
+            const char* text = label.c_str();
+            char el_label[256];
+
+            if constexpr (std::is_same_v<T, UDT_ARRAY>) {
+                if (row.kind == TreeRow::Kind::ArrayElement) {
+                    // Elements are materialized only when the user opens them.
+                    key = ptr->find_element(row.index).get();
+                    std::snprintf(el_label, sizeof(el_label), "%s[%d]", text, row.index);
+                    text = el_label;
+                    ImGui::PushID(row.index);
                 }
+            }
+
+            const bool open = key != nullptr && open_nodes.count(key) > 0;
+            ImGui::SetNextItemOpen(open);
+            if (ImGui::TreeNodeEx(text, node_flags) != open) {
+                if constexpr (std::is_same_v<T, UDT_ARRAY>)
+                    if (row.kind == TreeRow::Kind::ArrayElement && key == nullptr)
+                        key = ptr->get_element(row.index).get();
+
+                if (open) open_nodes.erase(key);
+                else open_nodes.insert(key);
+                rows_dirty = true;
+            }
+            if (row.kind == TreeRow::Kind::ArrayElement) ImGui::PopID();
         }
-    },element);
+        ImGui::PopID();
+    }, row.el);
 }
 
 /// \brief Draws the left-hand explorer: buttons and directory tree.
@@ -313,52 +508,99 @@ void Body::Draw_Explorer()
     if (ImGui::Button("Add Directory")) {
         //this_controller->CommMan->DataMan.add_directory();
     }
-    _folder_ dirs = this_controller->CommMan->get_directory();
-    Draw_DirectoryTree(dirs);
+    ImGui::SameLine();
+
+    if (ImGui::Button("Refresh")) {
+        this_controller->CommMan->refresh_directory();
+    }
+
+    auto progress = this_controller->CommMan->DataMan.get_catalog().get_progress();
+    if (progress.total > 0)
+        ImGui::Text("%s %zu/%zu DBs (%.0f ms, %zu failed)", progress.running ? "Indexing" : "Indexed",
+                    progress.done, progress.total, progress.elapsed_ms, progress.failed);
+
+    auto udt = this_controller->CommMan->DataMan.get_catalog().get_udt_stats();
+    if (udt.reused > 0)
+        ImGui::Text("UDTs: %zu parsed, %zu reused (%.0f ms, %zu KiB saved)",
+                    udt.unique, udt.reused, udt.saved_ms, udt.saved_bytes / 1024);
+
+    // Cached tree, kept alive while drawn even if a rescan replaces it.
+    auto dirs = this_controller->CommMan->get_directory();
+    Draw_Folder(*dirs);
 
 }
 
-/// \brief Recursively renders a folder/file item in the explorer.
+/// \brief Formats a file write time as local "YYYY-MM-DD HH:MM".
+static void format_mtime(std::filesystem::file_time_type t,char* out,std::size_t size)
+{
+    using namespace std::chrono;
+    auto sys = time_point_cast<system_clock::duration>(t - std::filesystem::file_time_type::clock::now() + system_clock::now());
+    std::time_t tt = system_clock::to_time_t(sys);
+    std::tm tm_local{};
+    if (std::tm* p = std::localtime(&tt)) tm_local = *p;
+    std::strftime(out, size, "%Y-%m-%d %H:%M", &tm_local);
+}
+
+/// \brief Renders a folder/file item in the explorer.
 /// \param el Folder or file variant; files offer an “Open” button to load a DB.
 void Body::Draw_DirectoryTree(const FileFolderVar& el)
 {
-    if (std::holds_alternative<_folder_>(el))
+    if (std::holds_alternative<_folder_>(el)) Draw_Folder(std::get<_folder_>(el));
+    else Draw_File(std::get<_file_>(el));
+}
+
+/// \brief Renders a folder and, when open, its content.
+void Body::Draw_Folder(const _folder_& f)
+{
+    if (ImGui::TreeNodeEx(f.name.c_str(), ImGuiTreeNodeFlags_Framed|ImGuiTreeNodeFlags_OpenOnDoubleClick|ImGuiTreeNodeFlags_OpenOnArrow))
     {
-        _folder_ f = std::get<_folder_>(el);
-        if (ImGui::TreeNodeEx(f.name.c_str(), ImGuiTreeNodeFlags_Framed|ImGuiTreeNodeFlags_OpenOnDoubleClick|ImGuiTreeNodeFlags_OpenOnArrow))
-        {
-            for(auto i: f.elements) Draw_DirectoryTree(i);
-            ImGui::TreePop();
-        }
+        for(const auto& i: f.elements) Draw_DirectoryTree(i);
+        ImGui::TreePop();
+    }
+}
+
+/// \brief Renders a file; the tooltip shows its size, write time and parse status.
+void Body::Draw_File(const _file_& f)
+{
+    auto no_ext_name = f.name.substr(0,f.name.find("."));
+    bool open = ImGui::TreeNodeEx(no_ext_name.c_str(), ImGuiTreeNodeFlags_Framed|ImGuiTreeNodeFlags_OpenOnDoubleClick|ImGuiTreeNodeFlags_OpenOnArrow);
+    if (ImGui::IsItemHovered()) {
+        char mtime[32];
+        format_mtime(f.mtime, mtime, sizeof(mtime));
+
+        ImGui::BeginTooltip();
+        ImGui::Text("%.1f KiB, modified %s", f.size / 1024.0, mtime);
+        auto entry = this_controller->CommMan->DataMan.get_catalog().find(f.path);
+        if (entry == nullptr) ImGui::Text("Not indexed yet");
+        else if (!entry->error.empty()) ImGui::Text("Error: %s", entry->error.c_str());
+        else if (entry->db != nullptr && entry->db->get_arena() != nullptr)
+            ImGui::Text("%s in %.1f ms, tree %zu KiB in %zu nodes", entry->from_cache ? "Cache loaded" : "Parsed",
+                        entry->load_ms, entry->db->get_arena()->get_used() / 1024, entry->db->get_arena()->get_count());
+        else ImGui::Text("%s in %.1f ms", entry->from_cache ? "Cache loaded" : "Parsed", entry->load_ms);
+        ImGui::EndTooltip();
     }
-    else
+    if (open)
     {
-        _file_ f = std::get<_file_>(el);
-        auto no_ext_name = f.name.substr(0,f.name.find("."));
-        if (ImGui::TreeNodeEx(no_ext_name.c_str(), ImGuiTreeNodeFlags_Framed|ImGuiTreeNodeFlags_OpenOnDoubleClick|ImGuiTreeNodeFlags_OpenOnArrow))
-        {
-            if (ImGui::Button("Open")) {
-                DbInfo db = DbInfo();
-                db.default_number = 0;
-                db.name = f.name;
-                db.path = f.path;
-                this_controller->CommMan->DataMan.set_db_scope(db);
-            }
-            ImGui::SameLine();
+        if (ImGui::Button("Open")) {
+            DbInfo db = DbInfo();
+            db.default_number = 0;
+            db.name = f.name;
+            db.path = f.path;
+            this_controller->CommMan->DataMan.set_db_scope(db);
+        }
+        ImGui::SameLine();
 
-            if (ImGui::Button("Proprerties")) {
-                //this_controller->CommMan->add_directory();
-            }
-            ImGui::TreePop();
+        if (ImGui::Button("Proprerties")) {
+            //this_controller->CommMan->add_directory();
         }
-    }  
-};
+        ImGui::TreePop();
+    }
+}
 
 /// \brief Lays out and renders the explorer pane and (if present) the DB viewer.
 /// \param db Optional DB pointer; when present, draws a second pane with its tree.
 void Body::Draw(const std::shared_ptr<DB>& db) {
     
-    int depth;
     const float margin = 20.0f;   
     
     ImVec2 Cursor= this_controller->cursor->Cursor;
@@ -384,10 +626,21 @@ void Body::Draw(const std::shared_ptr<DB>& db) {
         ImGui::SetNextWindowSize(NextWin_Size);
         ImGui::SetNextWindowPos(NextWin_Pos);
         ImGui::Begin("FileShower", nullptr, window_type::blank);
-            for (const auto& element : db->get_childs()) {
-                Draw_node(element, depth);
-            }
+            if (rows_dirty || rows_db != db.get() || rows_tree_gen != class_utils::tree_generation()
+                || rows_vis_gen != class_utils::vis_generation())
+                _build_rows(db);
+
+            // Only the rows in the scrolled-to part of the window are submitted.
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(rows.size()));
+            while (clipper.Step())
+                for (int r = clipper.DisplayStart; r < clipper.DisplayEnd; ++r)
+                    _draw_row(rows[r]);
         ImGui::End();
+
+        // The leaves on screen are what the tree shows: only those are read and decoded.
+        this_controller->CommMan->DataMan.get_subscriptions().set("tree", shown);
+        shown.clear();
     }
 }
 
@@ -1,45 +1,63 @@
 #include <hw_interface.hpp>
+#include <db_cache.hpp>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <climits>
+
+/// Changes that alter the model: entries created, removed, renamed or rewritten.
+static constexpr uint32_t watch_mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_DELETE_SELF;
+#endif
 
 /// Recursively walks a directory tree and populates a hierarchical folder/file model.
 ///
 /// Builds a tree of `_folder_` and `_file_` nodes starting at `path`.  
 /// For each subdirectory, creates a `_folder_`, updates its `path`, recurses into it,
 /// then appends it to `dir.elements`. For each regular file, creates a `_file_`,
-/// sets its `path`, and appends it to `dir.elements`.
+/// sets its `path`, size and write time, and appends it to `dir.elements`. Parsed-DB caches
+/// (`.dbc`) are skipped.
 ///
-/// @note `f_path` is used as a mutable accumulator for the current path and is
-///       modified in-place during recursion.
-///       If you pass `f_path` by reference (as here), remember to restore it
-///       after the recursive call to avoid path growth across siblings.
-///       Consider passing `f_path` by value or using a local guard to restore it.
+/// @note Each child path is built from `f_path` of its own folder, so siblings never
+///       see each other's names (the paths are watched and indexed as they are).
 ///
 /// @param[out] dir     Destination node representing the current folder; will receive children.
 /// @param[in]  path    Filesystem path to traverse (on disk).
-/// @param[in,out] f_path Accumulated logical path stored in the model; updated during traversal.
-void folders::walk_dir(_folder_& dir, const std::string& path, std::string& f_path)
+/// @param[in]  f_path  Path of \p dir stored in the model; children get `f_path/<name>`.
+void folders::walk_dir(_folder_& dir, const std::string& path, const std::string& f_path)
 {
     for (const auto& i : fs::directory_iterator(path))
     {
         if (i.is_directory())
         {
             _folder_ subfolder(i.path().filename().string());
-            f_path += "/"+subfolder.name;
-            subfolder.path=f_path;
-            walk_dir(subfolder, i.path().string(),f_path);   
+            subfolder.path=f_path+"/"+subfolder.name;
+            walk_dir(subfolder, i.path().string(),subfolder.path);
             dir.elements.push_back(std::move(subfolder));
         
         }
         else
         {
+            if (i.path().extension() == db_cache::extension) continue;
             auto name = i.path().filename().string();
             //name = name.substr(0,name.find(".db"));
             _file_ new_file(name);
             new_file.path=f_path+"/"+new_file.name;
+            std::error_code ec;
+            new_file.size = i.file_size(ec);
+            new_file.mtime = i.last_write_time(ec);
             dir.elements.push_back(std::move(new_file));
         }
     }
 }
 
+/// On-disk project directory: `<cwd>/root`.
+std::string folders::root_path()
+{
+    return std::filesystem::current_path().string()+"/root";
+}
+
 /// Returns the root folder model by scanning (or creating) the base directory.
 ///
 /// Uses the current working directory as base and ensures a `root` subdirectory exists.
@@ -51,9 +69,7 @@ void folders::walk_dir(_folder_& dir, const std::string& path, std::string& f_pa
 ///       Adjust names if you want the label to mirror the physical directory name.
 _folder_ folders::get_instances()
 {
-    auto base =std::filesystem::current_path().string();
-
-    std::string directory = base+"/root";
+    std::string directory = root_path();
     std::string full_path = directory;
 
     if (!fs::exists(directory) || !fs::is_directory(directory))
@@ -66,3 +82,96 @@ _folder_ folders::get_instances()
     return root;
 }
 
+
+/*------------------- Project directory --------------------*/
+
+ProjectDirectory::~ProjectDirectory()
+{
+#ifdef __linux__
+    if (notify_fd >= 0) close(notify_fd);
+#endif
+}
+
+/// Scans the project directory and starts watching it for changes.
+void ProjectDirectory::open()
+{
+#ifdef __linux__
+    if (notify_fd < 0) {
+        notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (notify_fd < 0) std::cerr << "Cannot watch the project directory, use Refresh after changes.\n";
+    }
+#endif
+    _scan();
+}
+
+/// Drains the pending change events without blocking and rescans if one of them concerns
+/// the model (a folder or a non-cache file was created, removed, renamed or written).
+/// @return true if the tree was rebuilt.
+bool ProjectDirectory::poll()
+{
+#ifdef __linux__
+    if (notify_fd < 0) return false;
+
+    alignas(inotify_event) char buf[16 * (sizeof(inotify_event) + NAME_MAX + 1)];
+    bool changed = false;
+    for (;;) {
+        ssize_t len = read(notify_fd, buf, sizeof(buf));
+        if (len <= 0) break;
+
+        for (char* p = buf; p < buf + len;) {
+            auto* ev = reinterpret_cast<inotify_event*>(p);
+            p += sizeof(inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) { changed = true; continue; }
+            if (ev->mask & IN_IGNORED) continue;
+            std::string_view name = ev->len > 0 ? std::string_view(ev->name) : std::string_view();
+            auto ext = fs::path(name).extension();
+            if (ext == db_cache::extension || ext == ".tmp") continue;
+            changed = true;
+        }
+    }
+    if (!changed) return false;
+    _scan();
+    return true;
+#else
+    return false;
+#endif
+}
+
+/// Rescans now, whether or not a change was reported.
+void ProjectDirectory::refresh(){ _scan(); }
+
+/// Current tree; it is never modified, a rescan replaces it.
+std::shared_ptr<const _folder_> ProjectDirectory::get()const{ return tree; }
+
+/// Increases with every scan.
+unsigned long ProjectDirectory::get_version()const{ return version; }
+
+/// Walks the directory into a new tree and watches its folders (new ones included).
+void ProjectDirectory::_scan()
+{
+    auto scanned = std::make_shared<_folder_>(folders::get_instances());
+#ifdef __linux__
+    if (notify_fd >= 0) {
+        if (inotify_add_watch(notify_fd, folders::root_path().c_str(), watch_mask) < 0)
+            std::cerr << "Cannot watch " << folders::root_path() << "\n";
+        _watch(*scanned);
+    }
+#endif
+    tree = std::move(scanned);
+    ++version;
+}
+
+/// Adds a watch on every folder below \p dir (adding an existing watch is a no-op).
+void ProjectDirectory::_watch(const _folder_& dir)
+{
+#ifdef __linux__
+    for (const auto& el : dir.elements) {
+        if (!std::holds_alternative<_folder_>(el)) continue;
+        const auto& sub = std::get<_folder_>(el);
+        if (inotify_add_watch(notify_fd, sub.path.c_str(), watch_mask) < 0)
+            std::cerr << "Cannot watch " << sub.path << "\n";
+        _watch(sub);
+    }
+#endif
+}
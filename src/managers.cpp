@@ -1,58 +1,81 @@
 #include <managers.hpp>
 #include <classes.hpp>
 #include <hw_interface.hpp>
-#include <action.hpp>
 #include <thread>
 #include <profi_DCP.hpp>
 
 /* ---------------- Network Manager ---------------- */
 
 /// Constructor that initializes the Profinet client for network operations.
-NetManager::NetManager()
-    :network(profinet::PcapClient()) {}
+NetManager::NetManager() = default;
 
-/// Launches a network scan to identify all available devices.
-///  Take a look into profi_DCP.cpp for more information
+/// Launches a network scan to identify all available devices; replies are captured on a
+/// background thread. Take a look into profi_DCP.cpp for more information
 void NetManager::scan_network() { network.identifyAll(); }
 
+/// Runs discovery on the DCP frames saved in a .pcap file instead of the network card.
+void NetManager::replay_capture(const std::string& pcap_path) { network.replay(pcap_path); }
+
+/// Called once per frame: picks up the devices found by the running scan.
+void NetManager::update() { network.collect(); }
+
+/// True while a scan is still listening for replies.
+bool NetManager::is_scanning()const { return network.is_scanning(); }
+
 /// Returns a map of available network cards detected by the Profinet client.
 const std::map<std::string,std::string> NetManager::get_netCards(){ return network.get_cards(); }
 
-/// Returns a list of stored device keys for quick access.
-std::vector<profinet::DCP_Device>* NetManager::get_devices() 
-{
-    if(!network.get_lock()) devices = *network.get_devices();
-    return &devices; 
-}
+/// Returns the devices discovered so far (as of the last update()).
+const std::vector<profinet::DCP_Device>* NetManager::get_devices()const { return &network.get_devices(); }
 
 /// Returns the ip setted from the gui into the manager, can be a std::nullopt.
 const std::optional<std::string> NetManager::get_ip() { return ip_selected; }
 
-///  Connects to the active device and reads data from the specified PLC datablock into a buffer.
+/// Returns the endpoint (ip/rack/slot) of the selected device, std::nullopt if none.
+std::optional<PlcKey> NetManager::get_plc_key() const
+{
+    if(!ip_selected.has_value()) return std::nullopt;
+    return PlcKey{ip_selected.value(),rack,slot};
+}
+
+/// Returns latency/health counters of the pooled session to the selected device.
+std::optional<ConnectionStats> NetManager::get_connection_stats() const
+{
+    auto key = get_plc_key();
+    if(!key.has_value()) return std::nullopt;
+    for(auto& [k,st] : pool.get_stats())
+        if(k == key.value()) return st;
+    return std::nullopt;
+}
+
+/// Returns the pool of persistent PLC sessions.
+ConnectionPool& NetManager::get_pool(){ return pool; }
+
+///  Reads data from the specified PLC datablock into a buffer.
+///  The session to the active device is kept open in the pool and reused across reads.
 void NetManager::plc_data_retrieve(int db_nr,int size,std::vector<unsigned char>* buffer) 
 {
-    buffer->resize(size);
     if (!buffer) {
         std::cerr << "ERRORE: buffer è null!\n";
+        return;
     }
-    if (Client.ConnectTo(ip_selected.value().c_str(), 0, 1) == 0){
-        int res= Client.DBRead(db_nr,0,size,buffer->data());
-        Client.Disconnect();
+    buffer->resize(size);
+    auto key = get_plc_key();
+    if (!key.has_value()) {
+        std::cerr<<"No device selected\n";
+        return;
     }
-    else{ 
-        std::cerr<<"Error connecting to client\n";
-        return ;}
+    if (pool.acquire(key.value())->read(db_nr,0,size,buffer->data()) != 0)
+        std::cerr<<"Error reading DB "<<db_nr<<" from "<<key.value().to_string()<<"\n";
 }
 
-/// Connects to the active device and writes data to the specified PLC datablock.
-bool NetManager::plc_data_send(int db_nr,int size,std::vector<unsigned char> buffer ) 
+/// Writes the bytes of \p range from the DB image \p image to the PLC datablock through
+/// the pooled session of the active device; the rest of the DB is left untouched.
+bool NetManager::plc_data_send(int db_nr,const ByteRange& range,std::vector<unsigned char>& image)
 {
-    if(Client.ConnectTo(ip_selected.value().c_str(),0,1)==0){
-        Client.DBWrite(db_nr,0,size,buffer.data());
-        return true;
-    }
-    else{return false;}
-    Client.Disconnect();
+    auto key = get_plc_key();
+    if (!key.has_value() || range.start < 0 || range.end() > static_cast<int>(image.size())) return false;
+    return pool.acquire(key.value())->write(db_nr,range.start,range.size,image.data() + range.start) == 0;
 }
 
 /// Selects which network card to use for communication.
@@ -63,23 +86,34 @@ void NetManager::set_ip(std::string ip) { ip_selected = ip;}
 
 /* ---------------- Database Manager ---------------- */
 
-/// Parses and builds a new database object from the selected file path using the grammar parser.
+/// Builds a new database object from the selected file path.
+/// The project catalog is used when it holds the file with an unchanged hash; otherwise
+/// the file is loaded now (from its binary cache or the grammar parser) and cataloged.
 void DatabaseManager::create_db() 
 {
-    if(db_scope.name == "" ) {database = nullptr;}
+    if(db_scope.name == "" ) {database = nullptr;udt_database.clear();}
     else{
-        
-        ParserState state;
-        state.DB_name = db_scope.name;
-
-        pt::file_input<> in(db_scope.path);        
-        pt::parse<complete_datablock,action>(in, state);
+        auto entry = catalog.find(db_scope.path);
+        auto hash = db_cache::hash_file(db_scope.path);
 
+        if(entry == nullptr || !entry->error.empty() || !hash.has_value() || entry->hash != hash.value())
+            entry = catalog.load(db_scope.path,db_scope.name);
 
-        if(state.db == nullptr) std::cerr<<"DB not created";
-        state.db->_set_offset();
-        database = state.db;
+        if(entry->db == nullptr) std::cerr<<"DB not created";
+        database = entry->db;
+        udt_database = entry->udts;
     }
+    subscriptions.clear();
+    _plan_reads();
+}
+
+/// Computes the merged byte ranges that cover every field of the current DB.
+/// Fields closer than merge_gap bytes are read as one range.
+void DatabaseManager::_plan_reads()
+{
+    if(database == nullptr) { read_ranges.reset(); return; }
+    read_ranges = std::make_shared<const std::vector<ByteRange>>(
+        read_planner::merge(read_planner::collect_fields(database),merge_gap));
 }
 
 /// Returns the name of the currently loaded database.
@@ -97,6 +131,36 @@ int DatabaseManager::get_db_size()const{return database->get_max_offset().first;
 /// Returns the current database object.
 std::shared_ptr<DB> DatabaseManager::get_db(){return database;}
 
+/// Returns the catalog of every DB of the project.
+const DbCatalog& DatabaseManager::get_catalog()const{return catalog;}
+
+/// Returns the UDT definitions of the current database.
+const UdtRawMap& DatabaseManager::get_udts()const{return udt_database;}
+
+/// Returns the merged byte ranges to read for the current DB (null if no DB).
+SharedRanges DatabaseManager::get_read_ranges()const{return read_ranges;}
+
+/// Returns the merged byte ranges covering only the fields some view subscribed to.
+SharedRanges DatabaseManager::get_subscribed_ranges(){return subscriptions.get_ranges();}
+
+/// Returns the registry where views declare which DB elements they need.
+SubscriptionRegistry& DatabaseManager::get_subscriptions(){return subscriptions;}
+
+/// Returns the leaves whose value changed with the last set_db_data.
+const std::vector<BASE*>& DatabaseManager::get_changed_leaves()const{
+    static const std::vector<BASE*> none;
+    return database == nullptr ? none : database->get_changed();
+}
+
+/// Returns the gap (bytes) below which neighbouring fields are read as one range.
+int DatabaseManager::get_merge_gap()const{return merge_gap;}
+
+/// Updates the merge gap and re-plans the reads.
+void DatabaseManager::set_merge_gap(int gap){merge_gap = std::max(gap,0);subscriptions.set_merge_gap(merge_gap);_plan_reads();}
+
+/// Starts loading every DB below \p root in the background.
+void DatabaseManager::index_project(const _folder_& root){catalog.index(root);}
+
 /// Updates the default datablock number.
 /// It is necessary to be setted to perform readDB with snap7 lib 
 void DatabaseManager::set_db_nr(int* nr_in){db_scope.default_number = *nr_in;}
@@ -105,18 +169,65 @@ void DatabaseManager::set_db_nr(int* nr_in){db_scope.default_number = *nr_in;}
 void DatabaseManager::set_db_scope(DbInfo key){db_scope = key;create_db();}
 
 /// Loads raw PLC data into the database object for interpretation.
-void DatabaseManager::set_db_data(const std::vector<unsigned char> buffer){database->_set_data(buffer);}
+/// Only the subscribed leaves whose bytes changed since the previous read are decoded;
+/// when the subscriptions changed, every subscribed leaf is decoded once.
+void DatabaseManager::set_db_data(const std::vector<unsigned char> buffer)
+{
+    unsigned long version = subscriptions.get_version();
+    database->_set_data(buffer,subscriptions.get_leaves(),version != decoded_version);
+    decoded_version = version;
+}
 
 
 /*------------------- Filter Manager --------------------*/ 
 
-/// Applies a filter operation to the current database using the provided filter element.
+/// Queues an evaluation of the filter on the database; called when the filter inputs change.
 /// Possibilities of filter are Value, name or both togheter, more filter will be implemented in future
-void FilterManager::set_mode(std::shared_ptr<DB> db_ptr){ if(filter == nullptr) filter =std::make_unique<Filter::FilterDB>(db_ptr); filter->find_el(&filters);}
+void FilterManager::set_mode(std::shared_ptr<DB> db){ active = true; if(db != nullptr) _submit(db); }
+
+/// Hands the current filter on \p db to the worker.
+void FilterManager::_submit(const std::shared_ptr<DB>& db)
+{
+    if(db != db_ptr && db_ptr != nullptr && applied != nullptr) Filter::FilterDB(db_ptr).resetAll();
+    if(db != db_ptr) applied.reset();
 
+    db_ptr = db;
+    query_data_version = db->get_data_version();
+    worker.submit(Filter::FilterQuery::capture(db,filters));
+}
+
+/// Called once per frame while the filter is on: re-queries only if the DB or (for value/Bool
+/// filters) its values changed since the last query, then applies the newest result of
+/// the worker in one pass. A UDT array element opened since the last apply gets the result
+/// on screen applied to its nodes.
+void FilterManager::update(const std::shared_ptr<DB>& db)
+{
+    if(!active || db == nullptr) return;
+
+    bool by_value = filters.value_in.has_value() || filters.bool_el.has_value();
+    if(db != db_ptr || (by_value && db->get_data_version() != query_data_version)) _submit(db);
+
+    auto result = worker.fetch();
+    if(result == nullptr || result->query->db != db_ptr){
+        if(applied != nullptr && applied_tree_gen != class_utils::tree_generation()){
+            Filter::FilterWorker::apply(*applied,nullptr);
+            applied_tree_gen = class_utils::tree_generation();
+        }
+        return;
+    }
+    Filter::FilterWorker::apply(*result,applied_tree_gen == class_utils::tree_generation() ? applied.get() : nullptr);
+    applied = result;
+    applied_tree_gen = class_utils::tree_generation();
+}
+
+/// Shows every element again; called each frame while the filter is off, so the tree is
+/// only walked after a filter was applied.
 void FilterManager::reset_mode()
 {
-    if(filter != nullptr)filter->resetAll() ;
+    if(active) worker.cancel();
+    active = false;
+    if(db_ptr != nullptr && applied != nullptr) Filter::FilterDB(db_ptr).resetAll();
+    applied.reset();
     filters.bool_el.reset();
     filters.comment.reset();
     filters.name.reset();
@@ -131,23 +242,226 @@ Filter::filterElem* FilterManager::get_filter(){ return &filters; };
 /*------------------- Common Manager --------------------*/ 
 /*-------------------------------------------------------*/
 
-/// Default class Constructor.
-CommManager::CommManager()=default;
+/// Class constructor: scans the project directory and starts indexing its DBs in the background.
+CommManager::CommManager()
+{
+    project.open();
+    DataMan.index_project(*get_directory());
+}
 
 /// Default class destructor.
 CommManager::~CommManager()=default; 
 
-/// Reads PLC data through NetManager and updates the DatabaseManager with the new buffer.
+/// Builds the poller target from the selected device and the loaded DB, std::nullopt if incomplete.
+std::optional<PollConfig> CommManager::_make_poll_config()
+{
+    auto key = NetMan.get_plc_key();
+    if(!key.has_value() || DataMan.get_db() == nullptr) return std::nullopt;
+
+    PollConfig cfg;
+    cfg.key = key.value();
+    cfg.db_nr = DataMan.get_db_default_number();
+    cfg.size = DataMan.get_db_size()+1;
+    cfg.ranges = DataMan.get_subscribed_ranges();
+    cfg.cycle = std::chrono::milliseconds(poll_cycle_ms);
+    return cfg;
+}
+
+/// Pushes the current device/DB/cycle selection to the poller when it changed.
+/// Returns false (and stops cyclic reads) if there is nothing to read, or if the selected
+/// PLC is scheduled: its data then comes from the scheduler, a poller would be a second
+/// reader on the same session.
+bool CommManager::_sync_poll_config()
+{
+    auto cfg = _make_poll_config();
+    if(!cfg.has_value() || Scheduler.has(cfg->key)){
+        if(poll_config.has_value()) Poller.stop();
+        poll_config.reset();
+        return false;
+    }
+    if(!poll_config.has_value() || !poll_config->same_target(cfg.value()) || poll_config->cycle != cfg->cycle){
+        Poller.configure(cfg.value());
+        poll_config = cfg;
+    }
+    return true;
+}
+
+/// Keeps the whole DB subscribed while a value filter is active, since filtering by value
+/// needs every leaf decoded, not only the ones on screen.
+void CommManager::_sync_filter_subscription()
+{
+    auto& subs = DataMan.get_subscriptions();
+    auto* f = FilMan.get_filter();
+    bool needs_values = f->value_in.has_value() || f->bool_el.has_value();
+
+    if(needs_values && DataMan.get_db() != nullptr){
+        if(!subs.has("filter")) subs.set("filter",DataMan.get_db()->get_childs());
+    }
+    else subs.unsubscribe("filter");
+}
+
+/// Requests an asynchronous read of the DB; the result is applied by update() once available.
 void CommManager::get_plc_data(){
-    NetMan.plc_data_retrieve(DataMan.get_db_default_number(),DataMan.get_db_size()+1,&buffer);
+    if(_sync_poll_config()) Poller.request_once();
+}
+
+/// Takes the newest snapshot of every scheduled PLC into \c plc_images.
+void CommManager::_fetch_schedule()
+{
+    if(Scheduler.size() == 0) { plc_images.clear(); return; }
+    for(const auto& st : Scheduler.get_stats())
+        if(const PlcSnapshot* snap = Scheduler.fetch(st.key)) plc_images[st.key] = *snap;
+}
+
+/// Loads the scheduled image of the selected PLC into the DatabaseManager when a new one
+/// arrived for the current DB. Returns false if the selected PLC is not scheduled.
+bool CommManager::_show_scheduled()
+{
+    auto key = NetMan.get_plc_key();
+    if(!key.has_value() || !Scheduler.has(key.value())) { shown_image.reset(); return false; }
+
+    auto it = plc_images.find(key.value());
+    if(it == plc_images.end() || it->second.dbs.empty() || DataMan.get_db() == nullptr) return true;
+    if(shown_image.has_value() && shown_image->first == key.value() && shown_image->second == it->second.seq) return true;
+
+    const DbSnapshot& d = it->second.dbs.front();
+    last_result = d.result;
+    if(d.cycle_ms > 0.0) last_cycle_ms = d.cycle_ms;
+    // Scheduled for another DB (or before the DB was reloaded): not an image of this one.
+    if(d.result != 0 || d.db_nr != DataMan.get_db_default_number() || d.ranges != DataMan.get_read_ranges() ||
+        static_cast<int>(d.buffer.size()) < DataMan.get_db_size()+1) return true;
+
+    shown_image = std::make_pair(key.value(), it->second.seq);
+    _merge_image(key.value(), d);
+    return true;
+}
+
+/// Copies the ranges read by \p snap into the persistent image \c buffer and decodes it.
+/// \details Poller snapshots hold only the subscribed ranges, their other bytes are zero or
+/// from an older cycle; merging keeps every byte of \c buffer from the last read that
+/// actually covered it. The image starts over when the PLC or the DB changes.
+void CommManager::_merge_image(const PlcKey& key,const DbSnapshot& snap)
+{
+    if(!image_key.has_value() || !(image_key.value() == key) || image_db != DataMan.get_db().get() ||
+        image_db_nr != snap.db_nr || buffer.size() != snap.buffer.size()){
+        buffer.assign(snap.buffer.size(), 0);
+        image_key = key;
+        image_db = DataMan.get_db().get();
+        image_db_nr = snap.db_nr;
+    }
+
+    if(snap.ranges == nullptr) buffer = snap.buffer;
+    else
+        for(const auto& r : *snap.ranges)
+            if(r.start >= 0 && r.end() <= static_cast<int>(buffer.size()))
+                std::copy(snap.buffer.begin() + r.start, snap.buffer.begin() + r.end(), buffer.begin() + r.start);
     DataMan.set_db_data(buffer);
 }
 
-/// Retrieves the directory object from the folder manager.
-_folder_ CommManager::get_directory(){return folders::get_instances();};
+/// Called once per frame: follows selection changes and loads the newest snapshot of the
+/// selected PLC (from the scheduler if it is scheduled, otherwise from the poller) into the
+/// DatabaseManager. Never waits on the network.
+void CommManager::update()
+{
+    project.poll();
+    NetMan.update();
+    _sync_filter_subscription();
+    _sync_poll_config();
+    FilMan.update(DataMan.get_db());
+
+    _fetch_schedule();
+    if(_show_scheduled()) return;
+
+    const DbSnapshot* snap = Poller.fetch();
+    if(snap == nullptr) return;
+
+    last_result = snap->result;
+    if(snap->cycle_ms > 0.0) last_cycle_ms = snap->cycle_ms;
+    if(snap->result != 0 || !poll_config.has_value()) return;
+
+    if(!(snap->key == poll_config->key) || snap->db_nr != poll_config->db_nr ||
+        static_cast<int>(snap->buffer.size()) < poll_config->size) return;
+
+    // The subscriptions changed while the read was in flight: the snapshot does not cover
+    // the leaves now on screen. Cyclic reads catch up by themselves, a one-shot read is redone.
+    if(snap->ranges != poll_config->ranges){
+        if(!Poller.is_running()) Poller.request_once();
+        return;
+    }
+
+    _merge_image(snap->key, *snap);
+}
+
+/// Returns the configured polling cycle in milliseconds.
+int CommManager::get_poll_cycle()const{ return poll_cycle_ms; }
+
+/// Returns the achieved time between the last two cyclic reads.
+double CommManager::get_last_cycle()const{ return last_cycle_ms; }
+
+/// Returns the snap7 result of the last read published by the poller.
+int CommManager::get_last_result()const{ return last_result; }
+
+/// True while the poller is reading cyclically.
+bool CommManager::is_polling(){ return Poller.is_running(); }
+
+/// Newest image of every scheduled PLC, refreshed by update().
+const std::map<PlcKey,PlcSnapshot>& CommManager::get_plc_images()const{ return plc_images; }
+
+/// Sets the polling cycle; applied to the poller on the next update().
+void CommManager::set_poll_cycle(int cycle_ms){ poll_cycle_ms = cycle_ms; }
+
+/// Starts cyclic reads of the selected DB.
+void CommManager::start_polling(){
+    if(_sync_poll_config()) Poller.start();
+}
 
-/// Writes the current buffer to the PLC via NetManager.
-void CommManager::set_plc_data(){NetMan.plc_data_retrieve(DataMan.get_db_default_number(),DataMan.get_db_size(),&buffer);}
+/// Stops cyclic reads.
+void CommManager::stop_polling(){ Poller.stop(); last_cycle_ms = 0.0; }
+
+/// Schedules cyclic acquisition of the current DB on every PLC found by the DCP scan,
+/// each PLC on its own pooled session, using the configured polling cycle.
+/// Every field of the DB is read, since the images of PLCs not on screen have no
+/// subscriptions; update() keeps the newest image of each (get_plc_images()) and shows
+/// the selected PLC from it instead of polling it.
+void CommManager::schedule_all_devices()
+{
+    if(DataMan.get_db() == nullptr) return;
+
+    DbRequest req;
+    req.db_nr = DataMan.get_db_default_number();
+    req.size = DataMan.get_db_size()+1;
+    req.ranges = DataMan.get_read_ranges();
+
+    for(const auto& dev : *NetMan.get_devices())
+    {
+        if(!dev.ip.has_value()) continue;
+        PlcJobConfig job;
+        job.key = PlcKey{dev.ip.value().get_ip(),0,1};
+        job.dbs.push_back(req);
+        job.cycle = std::chrono::milliseconds(poll_cycle_ms);
+        Scheduler.add(job);
+    }
+}
+
+/// Stops the acquisition of all scheduled PLCs; the selected PLC goes back to the poller
+/// on the next read request.
+void CommManager::clear_schedule(){ Scheduler.clear(); plc_images.clear(); shown_image.reset(); }
+
+/// Cached project directory, rescanned only when it changes (see ProjectDirectory).
+std::shared_ptr<const _folder_> CommManager::get_directory()const{return project.get();};
+
+/// Rescans the project directory now.
+void CommManager::refresh_directory(){ project.refresh(); }
+
+/// Writes the bytes of \p leaf from the DB image to the PLC via NetManager.
+/// \details Only the range of the edited leaf is written: the image is valid only where it
+/// was read, writing the whole DB would overwrite the unsubscribed fields.
+void CommManager::set_plc_data(const BASE& leaf)
+{
+    if(!NetMan.plc_data_send(DataMan.get_db_default_number(),read_planner::field_range(leaf),buffer))
+        std::cerr<<"Error writing "<<leaf.get_name()<<" to DB "<<DataMan.get_db_default_number()<<"\n";
+}
 
-/// Applies a filtering mode to the database through the FilterManager.
+/// Re-evaluates the filter on the database through the FilterManager; called when the
+/// filter inputs change, the result is applied by update() once the worker is done.
 void CommManager::set_filter_mode(){ FilMan.set_mode(DataMan.get_db()); }
\ No newline at end of file
@@ -84,7 +84,7 @@ void ParserState::insert_element_inscope(){
     else{
         if(!is_arr){
             std::visit([&](auto&& ptr) {
-                std::shared_ptr<STD_SINGLE> el = std::make_shared<STD_SINGLE>(name,type,par);
+                std::shared_ptr<STD_SINGLE> el = arena::make<STD_SINGLE>(name,type,par);
                 ptr->insert_child(el);
             },element);
         }
@@ -0,0 +1,286 @@
+#include <plc_connection.hpp>
+
+using namespace std::chrono;
+
+/// \brief Snap7 packs TCP (low word) and ISO (bits 16..19) errors below this mask;
+/// anything above is a CPU/client level error that does not invalidate the session.
+static constexpr int transport_error_mask = 0x000FFFFF;
+
+/// \brief Weight of the newest sample in the read latency moving average.
+static constexpr double latency_alpha = 0.2;
+
+/// \brief Milliseconds elapsed since \p t0.
+static double elapsed_ms(steady_clock::time_point t0)
+{
+    return duration<double,std::milli>(steady_clock::now() - t0).count();
+}
+
+/* ---------------- PlcKey ---------------- */
+
+/// \brief Strict ordering used as map key (ip, rack, slot).
+bool PlcKey::operator<(const PlcKey& other) const
+{
+    if (ip != other.ip) return ip < other.ip;
+    if (rack != other.rack) return rack < other.rack;
+    return slot < other.slot;
+}
+
+/// \brief Equality on all endpoint fields.
+bool PlcKey::operator==(const PlcKey& other) const
+{
+    return ip == other.ip && rack == other.rack && slot == other.slot;
+}
+
+/// \brief Human readable "ip (R/S)" label.
+std::string PlcKey::to_string() const
+{
+    return ip + " (" + std::to_string(rack) + "/" + std::to_string(slot) + ")";
+}
+
+/* ---------------- PlcConnection ---------------- */
+
+/// \brief Publishes the counters when a request returns, on every path.
+struct PlcConnection::PublishGuard
+{
+    PlcConnection& conn;
+    ~PublishGuard() { conn._publish(); }
+};
+
+/// \brief Creates an idle session for \p key_in; the handshake happens on first use.
+PlcConnection::PlcConnection(PlcKey key_in)
+    : key(std::move(key_in)) {}
+
+/// \brief Closes the session if still open.
+PlcConnection::~PlcConnection() { _drop(); }
+
+/// \brief Copies \c stats to the published counters. Caller must hold \c mtx.
+void PlcConnection::_publish()
+{
+    std::lock_guard<std::mutex> lk(stats_mtx);
+    published = stats;
+}
+
+/// \brief True when snap7 reports a socket/ISO level failure.
+bool PlcConnection::_is_transport_error(int res) { return (res & transport_error_mask) != 0; }
+
+/// \brief Opens the session if needed and records handshake latency.
+/// \return true if the session is usable. Caller must hold \c mtx.
+bool PlcConnection::_ensure_connected()
+{
+    if (stats.connected && client.Connected()) return true;
+    if (stats.connected) _drop();
+
+    auto t0 = steady_clock::now();
+    int res = client.ConnectTo(key.ip.c_str(), key.rack, key.slot);
+    if (res != 0) {
+        stats.last_error = res;
+        std::cerr << "Error connecting to " << key.to_string() << ": " << CliErrorText(res) << "\n";
+        return false;
+    }
+    stats.handshake_ms = elapsed_ms(t0);
+    stats.pdu_length = client.PDULength();
+    stats.connected = true;
+    ++stats.connects;
+    return true;
+}
+
+/// \brief Disconnects the client and marks the session closed. Caller must hold \c mtx.
+void PlcConnection::_drop()
+{
+    if (stats.connected) client.Disconnect();
+    stats.connected = false;
+}
+
+/// \brief Reads \p size bytes of DB \p db_nr from \p start into \p dst.
+/// \details Reconnects on demand and retries once after a transport error.
+/// \return 0 on success, snap7 error code otherwise.
+int PlcConnection::read(int db_nr,int start,int size,unsigned char* dst)
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    PublishGuard publish{*this};
+    int res = -1;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (!_ensure_connected()) { res = stats.last_error; break; }
+
+        auto t0 = steady_clock::now();
+        res = client.DBRead(db_nr, start, size, dst);
+        if (res == 0) {
+            int pdu_payload = read_planner::max_item_payload(stats.pdu_length);
+            _record_read(t0, size, (size + pdu_payload - 1) / pdu_payload);
+            return 0;
+        }
+        stats.last_error = res;
+        if (!_is_transport_error(res)) break;
+        _drop();
+    }
+    ++stats.errors;
+    return res;
+}
+
+/// \brief Reads only the given byte ranges of DB \p db_nr into the DB image \p dst.
+/// \details \p ranges come from read_planner::merge(); they are split and packed into
+/// ReadMultiVars batches sized to the PDU negotiated by this session. Each range lands at
+/// its own offset in \p dst, bytes outside the ranges are left untouched.
+/// \return 0 on success, snap7 error code (or first failing item result) otherwise.
+int PlcConnection::read_ranges(int db_nr,const std::vector<ByteRange>& ranges,unsigned char* dst)
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    PublishGuard publish{*this};
+    int res = -1;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (!_ensure_connected()) { res = stats.last_error; break; }
+
+        ReadPlan plan = read_planner::plan(ranges, stats.pdu_length);
+        auto t0 = steady_clock::now();
+        res = _read_plan(db_nr, plan, dst);
+        if (res == 0) {
+            _record_read(t0, plan.total_bytes, static_cast<int>(plan.batches.size()));
+            return 0;
+        }
+        stats.last_error = res;
+        if (!_is_transport_error(res)) break;
+        _drop();
+    }
+    ++stats.errors;
+    return res;
+}
+
+/// \brief Executes the batches of \p plan. Caller must hold \c mtx.
+int PlcConnection::_read_plan(int db_nr,const ReadPlan& plan,unsigned char* dst)
+{
+    for (const auto& batch : plan.batches) {
+        items.resize(batch.items.size());
+        for (size_t i = 0; i < batch.items.size(); ++i) {
+            TS7DataItem& it = items[i];
+            it.Area = S7AreaDB;
+            it.WordLen = S7WLByte;
+            it.Result = 0;
+            it.DBNumber = db_nr;
+            it.Start = batch.items[i].start;
+            it.Amount = batch.items[i].size;
+            it.pdata = dst + batch.items[i].start;
+        }
+        int res = client.ReadMultiVars(items.data(), static_cast<int>(items.size()));
+        if (res != 0) return res;
+        for (const auto& it : items)
+            if (it.Result != 0) return it.Result;
+    }
+    return 0;
+}
+
+/// \brief Updates read latency/volume counters after a successful read. Caller must hold \c mtx.
+void PlcConnection::_record_read(steady_clock::time_point t0,int bytes,int requests)
+{
+    stats.last_read_ms = elapsed_ms(t0);
+    stats.avg_read_ms = stats.reads == 0
+        ? stats.last_read_ms
+        : stats.avg_read_ms + latency_alpha * (stats.last_read_ms - stats.avg_read_ms);
+    stats.last_read_bytes = bytes;
+    stats.last_read_requests = requests;
+    ++stats.reads;
+}
+
+/// \brief Writes \p size bytes from \p src into DB \p db_nr starting at \p start.
+/// \return 0 on success, snap7 error code otherwise.
+int PlcConnection::write(int db_nr,int start,int size,unsigned char* src)
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    PublishGuard publish{*this};
+    int res = -1;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (!_ensure_connected()) { res = stats.last_error; break; }
+
+        auto t0 = steady_clock::now();
+        res = client.DBWrite(db_nr, start, size, src);
+        if (res == 0) {
+            stats.last_write_ms = elapsed_ms(t0);
+            ++stats.writes;
+            return 0;
+        }
+        stats.last_error = res;
+        if (!_is_transport_error(res)) break;
+        _drop();
+    }
+    ++stats.errors;
+    return res;
+}
+
+/// \brief Health check: the session is open and the socket still alive.
+bool PlcConnection::is_healthy()
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    PublishGuard publish{*this};
+    if (stats.connected && !client.Connected()) _drop();
+    return stats.connected;
+}
+
+/// \brief Closes the session; the next request performs a new handshake.
+void PlcConnection::disconnect()
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    PublishGuard publish{*this};
+    _drop();
+}
+
+/// \brief Endpoint of this session.
+const PlcKey& PlcConnection::get_key() const { return key; }
+
+/// \brief Latency/health counters as of the end of the last request; never blocks on I/O.
+ConnectionStats PlcConnection::get_stats() const
+{
+    std::lock_guard<std::mutex> lk(stats_mtx);
+    return published;
+}
+
+/* ---------------- ConnectionPool ---------------- */
+
+/// \brief Closes every pooled session.
+ConnectionPool::~ConnectionPool() { release_all(); }
+
+/// \brief Returns the session for \p key, creating it on first request.
+std::shared_ptr<PlcConnection> ConnectionPool::acquire(const PlcKey& key)
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    auto it = connections.find(key);
+    if (it == connections.end())
+        it = connections.emplace(key, std::make_shared<PlcConnection>(key)).first;
+    return it->second;
+}
+
+/// \brief Closes and forgets the session for \p key (if any).
+void ConnectionPool::remove(const PlcKey& key)
+{
+    std::shared_ptr<PlcConnection> conn;
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        auto it = connections.find(key);
+        if (it == connections.end()) return;
+        conn = it->second;
+        connections.erase(it);
+    }
+    conn->disconnect();
+}
+
+/// \brief Closes and forgets every session.
+void ConnectionPool::release_all()
+{
+    std::map<PlcKey,std::shared_ptr<PlcConnection>> old;
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        old.swap(connections);
+    }
+    for (auto& [key, conn] : old) conn->disconnect();
+}
+
+/// \brief Per-endpoint statistics, ordered by key.
+std::vector<std::pair<PlcKey,ConnectionStats>> ConnectionPool::get_stats() const
+{
+    std::vector<std::shared_ptr<PlcConnection>> conns;
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        for (auto& [key, conn] : connections) conns.push_back(conn);
+    }
+    std::vector<std::pair<PlcKey,ConnectionStats>> out;
+    for (auto& conn : conns) out.emplace_back(conn->get_key(), conn->get_stats());
+    return out;
+}
@@ -0,0 +1,156 @@
+#include <poller.hpp>
+
+using namespace std::chrono;
+
+/// \brief Milliseconds between two time points.
+static double span_ms(steady_clock::time_point from,steady_clock::time_point to)
+{
+    return duration<double,std::milli>(to - from).count();
+}
+
+/// \brief True if both configs read the same bytes from the same PLC (cycle ignored).
+bool PollConfig::same_target(const PollConfig& other) const
+{
+    return key == other.key && db_nr == other.db_nr && size == other.size && ranges == other.ranges;
+}
+
+/// \brief Creates the poller and its (idle) worker thread.
+CyclicPoller::CyclicPoller(ConnectionPool* pool_in)
+    : pool(pool_in)
+{
+    worker = std::thread(&CyclicPoller::_run, this);
+}
+
+/// \brief Stops and joins the worker thread.
+CyclicPoller::~CyclicPoller()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        stop_requested = true;
+    }
+    cv.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+/// \brief Sets the PLC/DB to read and the cycle time; takes effect on the next read.
+void CyclicPoller::configure(const PollConfig& cfg)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        config = cfg;
+        has_config = true;
+    }
+    cv.notify_all();
+}
+
+/// \brief Starts cyclic reads (first read immediately) if a cycle time is configured.
+void CyclicPoller::start()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        if (!has_config || config.cycle.count() <= 0) return;
+        cyclic = true;
+        once_requested = true;
+    }
+    cv.notify_all();
+}
+
+/// \brief Stops cyclic reads; an in-flight read still completes and is published.
+void CyclicPoller::stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        cyclic = false;
+    }
+    cv.notify_all();
+}
+
+/// \brief Schedules a single asynchronous read of the configured DB.
+void CyclicPoller::request_once()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        once_requested = true;
+    }
+    cv.notify_all();
+}
+
+/// \brief True while cyclic reads are active.
+bool CyclicPoller::is_running()
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    return cyclic;
+}
+
+/// \brief Current configuration, std::nullopt if never configured.
+std::optional<PollConfig> CyclicPoller::get_config()
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    if (!has_config) return std::nullopt;
+    return config;
+}
+
+/// \brief Newest snapshot since the last call, or nullptr. GUI thread only.
+const DbSnapshot* CyclicPoller::fetch() { return handoff.fetch(); }
+
+/// \brief Worker loop: waits for a request or the next cycle deadline, then reads.
+/// \details Deadlines advance by the cycle time so the period does not drift; after an
+/// overrun the schedule restarts from the current read instead of bursting to catch up.
+void CyclicPoller::_run()
+{
+    steady_clock::time_point next{};
+    steady_clock::time_point last_start{};
+
+    std::unique_lock<std::mutex> lk(mtx);
+    while (!stop_requested)
+    {
+        if (!has_config || (!cyclic && !once_requested)) {
+            cv.wait(lk);
+            continue;
+        }
+        if (!once_requested &&
+            cv.wait_until(lk, next, [&]{ return stop_requested || once_requested || !cyclic; }))
+            continue;
+
+        PollConfig cfg = config;
+        bool was_cyclic = cyclic;
+        once_requested = false;
+        lk.unlock();
+
+        auto t0 = steady_clock::now();
+        _read(cfg, was_cyclic ? last_start : steady_clock::time_point{});
+        last_start = t0;
+
+        lk.lock();
+        if (was_cyclic) {
+            next += cfg.cycle;
+            if (next < t0) next = t0 + cfg.cycle;
+        }
+    }
+}
+
+/// \brief Reads the configured DB into the producer slot and publishes it.
+void CyclicPoller::_read(const PollConfig& cfg,steady_clock::time_point last_start)
+{
+    DbSnapshot& snap = handoff.write_slot();
+    snap.buffer.resize(cfg.size);
+    if (cfg.ranges && !cfg.ranges->empty() && cfg.ranges->back().end() > cfg.size)
+        snap.buffer.resize(cfg.ranges->back().end());
+
+    auto t0 = steady_clock::now();
+    auto conn = pool->acquire(cfg.key);
+    snap.result = cfg.ranges
+        ? conn->read_ranges(cfg.db_nr, *cfg.ranges, snap.buffer.data())
+        : conn->read(cfg.db_nr, 0, cfg.size, snap.buffer.data());
+    auto t1 = steady_clock::now();
+
+    snap.key = cfg.key;
+    snap.db_nr = cfg.db_nr;
+    snap.ranges = cfg.ranges;
+    snap.seq = ++seq;
+    snap.stamp = t0;
+    snap.read_ms = span_ms(t0, t1);
+    snap.cycle_ms = last_start == steady_clock::time_point{} ? 0.0 : span_ms(last_start, t0);
+
+    handoff.publish();
+}
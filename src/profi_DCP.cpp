@@ -135,7 +135,10 @@ std::array<uint8_t,6> profinet::PcapClient::_get_mac()
 
 /// \brief Constructor: enumerates interfaces via pcap.
 profinet::PcapClient::PcapClient()
-    : net_cards(_get_netCards()),devices(std::make_shared<std::vector<profinet::DCP_Device>>()),lock(false){};
+    : net_cards(_get_netCards()){};
+
+/// \brief Destructor: ends a running scan and joins the capture thread.
+profinet::PcapClient::~PcapClient(){ _stop(); }
 
 /// \brief Enumerate NICs and build "index: label" -> pcap name map.
 /// \throws std::runtime_error if pcap_findalldevs fails.
@@ -180,38 +183,110 @@ std::map<std::string,std::string> profinet::PcapClient::_get_netCards()
     return cards;  // ← ora ritorni la mappa riempita
 };
 
-/// \brief Send DCP Identify request and run a capture loop to collect responses.
-/// \details Opens the selected NIC in promiscuous mode, installs 0x8892 BPF, sends frame,
-/// enables nonblocking mode and runs a bounded pcap_loop. Closes the handle on exit.
+/// \brief Send DCP Identify request and start the capture thread that collects responses.
+/// \details Ends a previous scan first. Opens the selected NIC in promiscuous mode, installs
+/// the 0x8892 BPF and sends the frame; the capture thread then owns the handle for
+/// scan_window and closes it. Devices reach the GUI thread through collect().
 int profinet::PcapClient::identifyAll()
 {   
-    int pcap_res;
-    const char* card = net_card.c_str();
-    live_process = pcap_open_live(card,65535,1,500,errbuf);
-    time_out= std::chrono::steady_clock::now()+seconds(120) ;
+    _stop();
+
     mac_addr=_get_mac();
+    pcap_t* process = pcap_open_live(net_card.c_str(),65535,1,500,errbuf);
+    if(process == nullptr)
+    {
+        std::cerr<<"Cannot open network card "<<net_card<<": "<<errbuf<<"\n";
+        return PCAP_ERROR;
+    }
     
     auto tmp = packageHelper::build_DCP(&mac_addr,XID);
-    _set_filter(live_process);
+    _set_filter(process);
    
     u_char* dcp_req = reinterpret_cast<u_char*>(tmp.data());
     
     int len = tmp.size();
 
-    if(pcap_sendpacket(live_process,dcp_req,len)!=0 )
+    if(pcap_sendpacket(process,dcp_req,len)!=0 )
     {
-        std::cerr<<"No packed has been sent error: "<< pcap_geterr(live_process)<<"\n";
-        return pcap_res;
+        std::cerr<<"No packed has been sent error: "<< pcap_geterr(process)<<"\n";
+        pcap_close(process);
+        return PCAP_ERROR;
     }
-    else
-    {   
-        std::cout<<"sent frame, len: "<<std::to_string(len)<<"\n";
-        parser = profinet::PackageParser(devices,&lock,live_process);
-        pcap_setnonblock(live_process, 1, errbuf);
-    }    
+
+    std::cout<<"sent frame, len: "<<std::to_string(len)<<"\n";
+    _start(process,false);
     return 0;
 };
 
+/// \brief Replays the DCP frames of \p pcap_path through the capture thread, as if they
+/// answered an Identify: no NIC, no request sent. The scan ends at the end of the file.
+int profinet::PcapClient::replay(const std::string& pcap_path)
+{
+    _stop();
+
+    pcap_t* process = pcap_open_offline(pcap_path.c_str(),errbuf);
+    if(process == nullptr)
+    {
+        std::cerr<<"Cannot open capture "<<pcap_path<<": "<<errbuf<<"\n";
+        return PCAP_ERROR;
+    }
+    _start(process,true);
+    return 0;
+}
+
+/// \brief Starts the capture thread on \p process; it owns the handle from now on.
+void profinet::PcapClient::_start(pcap_t* process,bool from_file)
+{
+    {
+        std::lock_guard<std::mutex> lk(handle_mtx);
+        live_process = process;
+    }
+    offline = from_file;
+    stop_requested = false;
+    scanning = true;
+    capture = std::thread(&PcapClient::_capture, this, steady_clock::now() + scan_window);
+}
+
+/// \brief Capture loop: dispatches the replies of the running scan until \p deadline, the
+/// end of a replayed file or _stop(), then closes the handle and clears \c scanning.
+/// \details pcap_dispatch blocks for at most the 500 ms read timeout of the handle;
+/// _stop() interrupts it with pcap_breakloop().
+void profinet::PcapClient::_capture(steady_clock::time_point deadline)
+{
+    PackageParser parser(&found,live_process,&stop_requested);
+    while(!stop_requested && steady_clock::now() < deadline)
+    {
+        int res = parser.start();
+        if(res == PCAP_ERROR_BREAK) break;
+        if(res == 0 && offline) break;      // end of the capture file
+        if(res == PCAP_ERROR)
+        {
+            std::cerr<<"Capture error: "<<pcap_geterr(live_process)<<"\n";
+            break;
+        }
+    }
+    if(parser.get_dropped() > 0)
+        std::cerr<<parser.get_dropped()<<" DCP devices dropped, device queue full\n";
+
+    {
+        std::lock_guard<std::mutex> lk(handle_mtx);
+        pcap_close(live_process);
+        live_process = nullptr;
+    }
+    scanning = false;
+}
+
+/// \brief Interrupts the running scan and joins the capture thread.
+void profinet::PcapClient::_stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(handle_mtx);
+        stop_requested = true;
+        if(live_process != nullptr) pcap_breakloop(live_process);
+    }
+    if(capture.joinable()) capture.join();
+}
+
 /// \brief Return cached NIC map.
 std::map<std::string,std::string> profinet::PcapClient::get_cards(){ return net_cards;}
 
@@ -242,18 +317,125 @@ void profinet::PcapClient:: _set_filter(pcap_t* process)
     pcap_freecode(&prg);
 }
 
-/// \brief Get discovered DCP devices (if discovery ran).
-const std::shared_ptr<std::vector<profinet::DCP_Device>> profinet::PcapClient::get_devices()
+/// \brief Drains the queue of the capture thread into the device table.
+void profinet::PcapClient::collect()
+{
+    DCP_Device dev;
+    while(found.pop(dev)) devices.upsert(std::move(dev));
+}
+
+/// \brief Get discovered DCP devices, sorted by station name (empty until a scan found some).
+const std::vector<profinet::DCP_Device>& profinet::PcapClient::get_devices()const{ return devices.get_rows(); }
+
+/// \brief True from identifyAll() until the capture thread stops listening.
+bool profinet::PcapClient::is_scanning()const{ return scanning; }
+
+/* ---------------- Device Table ---------------- */
+
+/// \brief Sort key of a row: station name, then MAC.
+static std::pair<const std::string&,const std::string&> row_key(const profinet::DCP_Device& d)
+{
+    static const std::string none;
+    return { d.StationName.has_value() ? d.StationName.value() : none,
+             d.MAC.has_value() ? d.MAC.value() : none };
+}
+
+/// \brief Points the IP of \p dev to \p mac.
+void profinet::DeviceTable::_index_ip(const DCP_Device& dev,const std::string& mac)
+{
+    if(dev.ip.has_value()) mac_by_ip[dev.ip.value().get_ip()] = mac;
+}
+
+/// \brief Points the station name of \p dev to \p mac.
+void profinet::DeviceTable::_index_name(const DCP_Device& dev,const std::string& mac)
+{
+    if(dev.StationName.has_value()) mac_by_name[dev.StationName.value()] = mac;
+}
+
+/// \brief Adds \p dev, or updates the device with the same MAC.
+/// \details O(1): a known device is overwritten in its row, a new one is appended. The
+/// order is only marked dirty if the row no longer sorts after its predecessor and before
+/// its successor. Devices without MAC are keyed by IP.
+void profinet::DeviceTable::upsert(DCP_Device dev)
+{
+    if(!dev.MAC.has_value())
+    {
+        if(!dev.ip.has_value()) return;
+        dev.MAC = dev.ip.value().get_ip();
+    }
+    const std::string mac = dev.MAC.value();
+
+    size_t row;
+    auto known = row_by_mac.find(mac);
+    if(known != row_by_mac.end())
+    {
+        row = known->second;
+        if(rows[row].ip.has_value())
+        {
+            auto ip = mac_by_ip.find(rows[row].ip.value().get_ip());
+            if(ip != mac_by_ip.end() && ip->second == mac) mac_by_ip.erase(ip);
+        }
+        if(rows[row].StationName.has_value())
+        {
+            auto name = mac_by_name.find(rows[row].StationName.value());
+            if(name != mac_by_name.end() && name->second == mac) mac_by_name.erase(name);
+        }
+        _index_ip(dev, mac);
+        _index_name(dev, mac);
+        rows[row] = std::move(dev);
+    }
+    else
+    {
+        row = rows.size();
+        row_by_mac.emplace(mac, row);
+        _index_ip(dev, mac);
+        _index_name(dev, mac);
+        rows.push_back(std::move(dev));
+    }
+
+    if(sorted)
+        sorted = (row == 0 || !(row_key(rows[row]) < row_key(rows[row - 1]))) &&
+                 (row + 1 == rows.size() || !(row_key(rows[row + 1]) < row_key(rows[row])));
+}
+
+/// \brief Device with MAC \p mac, nullptr if unknown.
+const profinet::DCP_Device* profinet::DeviceTable::find_mac(const std::string& mac)const
+{
+    auto known = row_by_mac.find(mac);
+    return known == row_by_mac.end() ? nullptr : &rows[known->second];
+}
+
+/// \brief Device answering on \p ip, nullptr if unknown.
+const profinet::DCP_Device* profinet::DeviceTable::find_ip(const std::string& ip)const
 {
-    if(time_out.has_value()&&parser.has_value())
+    auto mac = mac_by_ip.find(ip);
+    return mac == mac_by_ip.end() ? nullptr : find_mac(mac->second);
+}
+
+/// \brief Device named \p name, nullptr if unknown.
+const profinet::DCP_Device* profinet::DeviceTable::find_name(const std::string& name)const
+{
+    auto mac = mac_by_name.find(name);
+    return mac == mac_by_name.end() ? nullptr : find_mac(mac->second);
+}
+
+/// \brief Every device, sorted by station name then MAC.
+/// \details Sorts the rows first if upserts broke the order, and re-points the MAC index.
+/// Pointers from find_mac()/find_ip()/find_name() are invalidated by the next upsert() or sort.
+const std::vector<profinet::DCP_Device>& profinet::DeviceTable::get_rows()const
+{
+    if(!sorted)
     {
-        if(std::chrono::steady_clock::now()>time_out.value()) pcap_close(live_process);
-        parser.value().start();
+        std::sort(rows.begin(), rows.end(),
+            [](const DCP_Device& a, const DCP_Device& b) { return row_key(a) < row_key(b); });
+        for(size_t i = 0; i < rows.size(); ++i) row_by_mac[rows[i].MAC.value()] = i;
+        sorted = true;
     }
-    return devices;
+    return rows;
 }
 
-const bool profinet::PcapClient::get_lock()const{ return lock;};
+/// \brief Number of devices.
+size_t profinet::DeviceTable::size()const{ return rows.size(); }
 
 /* ---------------- Frame builder ---------------- */
 
@@ -272,6 +454,41 @@ std::array<uint8_t,60> packageHelper::build_DCP(std::array<uint8_t,6>* mac_addre
     return frame;
 }
 
+/// \brief Build a PN-DCP Identify response frame (FrameID 0xFEFF, ServiceType success).
+/// \details Destination is a fixed requester MAC; every block starts with a zero BlockInfo
+/// and odd bodies are padded. The frame is padded to the 60-byte Ethernet minimum.
+std::vector<uint8_t> packageHelper::build_DCP_response(const std::array<uint8_t,6>& mac_address,const std::array<uint8_t,4>& XID,
+                                                      const std::string& family,const std::string& station,
+                                                      const std::array<uint8_t,4>& ip)
+{
+    std::vector<uint8_t> frame = {0x00, 0x0c, 0x29, 0x00, 0x00, 0x01};
+    frame.insert(frame.end(), mac_address.begin(), mac_address.end());
+    frame.insert(frame.end(), {0x88, 0x92,              // EtherType
+                               0xfe, 0xff,              // Frame ID: Identify response
+                               0x05, 0x01});            // Service ID, Service Type: success
+    frame.insert(frame.end(), XID.begin(), XID.end());
+    frame.insert(frame.end(), {0x00, 0x00,              // Reserved
+                               0x00, 0x00});            // DCPDataLength, set below
+
+    auto block = [&frame](uint8_t option, uint8_t suboption, const uint8_t* body, size_t size)
+    {
+        const size_t len = size + 2;                    // BlockInfo included
+        frame.insert(frame.end(), {option, suboption, static_cast<uint8_t>(len >> 8), static_cast<uint8_t>(len), 0x00, 0x00});
+        frame.insert(frame.end(), body, body + size);
+        if(len % 2) frame.push_back(0x00);
+    };
+    const std::array<uint8_t,12> ip_block = {ip[0], ip[1], ip[2], ip[3], 255, 0, 0, 0, ip[0], 0, 0, 1};
+    block(0x02, 0x01, reinterpret_cast<const uint8_t*>(family.data()), family.size());
+    block(0x02, 0x02, reinterpret_cast<const uint8_t*>(station.data()), station.size());
+    block(0x01, 0x02, ip_block.data(), ip_block.size());
+
+    const size_t dcp_len = frame.size() - 26;
+    frame[24] = static_cast<uint8_t>(dcp_len >> 8);
+    frame[25] = static_cast<uint8_t>(dcp_len);
+    if(frame.size() < frame_len) frame.resize(frame_len, 0x00);
+    return frame;
+}
+
 /// \brief Fill destination multicast, source MAC and EtherType (0x8892).
 void packageHelper::_build_ETH_header(std::array<uint8_t,frame_len>& frame,int& idx,std::array<uint8_t,6>* mac_address)
 {
@@ -338,9 +555,9 @@ void packageHelper::_build_DCP_message(std::array<uint8_t,frame_len>& frame,int&
 
 /* ---------------- Sniffer ---------------- */
 
-/// \brief Ctor: store external results vector pointer.
-profinet::PackageParser::PackageParser(std::shared_ptr<std::vector<profinet::DCP_Device>> _objs,bool* _lock,pcap_t* handle)
-    :objs(_objs),lock(_lock),handle_(handle){}
+/// \brief Ctor: store the output queue pointer.
+profinet::PackageParser::PackageParser(DeviceQueue* _out,pcap_t* handle,const std::atomic<bool>* _stop)
+    :out(_out),stop(_stop),handle_(handle){}
 
     /// \brief pcap callback trampoline -> onPacket().
 void profinet::PackageParser::pcap_cb(u_char* user, const pcap_pkthdr* h, const u_char* bytes) 
@@ -349,41 +566,38 @@ void profinet::PackageParser::pcap_cb(u_char* user, const pcap_pkthdr* h, const
     self->onPacket(h, bytes);
 }
 
-/// \brief Per-packet parser: decode DCP and append device if new/PLC-like.
+/// \brief Per-packet parser: decode DCP and queue the device if PLC-like.
+/// \details Duplicates are resolved by the consumer, see PcapClient::collect(). When the
+/// queue is full the capture thread waits for the GUI thread to drain it; the frames keep
+/// buffering in the kernel (or the capture file) meanwhile.
 void profinet::PackageParser::onPacket(const pcap_pkthdr* h, const u_char* bytes) 
 {
-    *lock = true;
     auto dev = profinet::DCP_Device::create(h->caplen,bytes);
-    bool exists  = false;
-    if(dev.has_value()&&dev.value().isPLC()) 
+    if(!dev.has_value() || !dev.value().isPLC()) return;
+    if(!dev.value().ip.has_value() || !dev.value().StationName.has_value()) return;
+
+    while(!out->push(std::move(dev.value())))
     {
-        if(objs->size()>1)
-            for(size_t i = 0 ;i < objs->size();i++)
-                if( objs->at(i).ip.value().get_ip()==dev.value().ip.value().get_ip())
-                {
-                    exists = true;
-                    break;
-                }
-        
-        if(!exists) 
+        if(stop == nullptr || *stop)
         {
-            objs->push_back(dev.value());
-            std::sort(objs->begin(), objs->end(),
-              [](const DCP_Device& a, const DCP_Device& b) {
-                  return a.StationName.value() < b.StationName.value(); // lexicografico
-              });
+            ++dropped_;
+            return;
         }
+        std::this_thread::sleep_for(milliseconds(1));
     }
-    *lock = false;
 }
 
-/// \brief Start pcap loop (bounded by packet count/time).
-void profinet::PackageParser::start() 
+/// \brief Dispatch the frames pending on the handle (at most 64 per call).
+int profinet::PackageParser::start() 
 {
     const int pkg_target = 64;
-    packets_ = pcap_dispatch(handle_, pkg_target, &PackageParser::pcap_cb,reinterpret_cast<u_char*>(this));
+    int res = pcap_dispatch(handle_, pkg_target, &PackageParser::pcap_cb,reinterpret_cast<u_char*>(this));
+    if(res > 0) packets_ += static_cast<size_t>(res);
+    return res;
 }
 
+/// \brief Devices that did not fit in the queue.
+size_t profinet::PackageParser::get_dropped()const{ return dropped_; }
 
 
 
@@ -393,7 +607,7 @@ void profinet::PackageParser::start()
 bool profinet::DCP_Device::isPLC(){ return Family.has_value() && Family.value().find("S7") != Family.value().npos; }
 
 /// \brief Get TLV class and base on it populate DCP_Device information.
-void profinet::DCP_Device::add_TLV(TLV tlv)
+void profinet::DCP_Device::add_TLV(const TLV& tlv)
 {
     if(tlv.get_option() == 0x02) 
         switch (tlv.get_suboption())
@@ -402,9 +616,11 @@ void profinet::DCP_Device::add_TLV(TLV tlv)
                 Family =  std::string(tlv.get_body().begin(), tlv.get_body().end());
                 break;
             case 0x02:
-                StationName  = std::string(tlv.get_body().begin(), tlv.get_body().end());
-                StationName  = StationName.value().substr(0,StationName.value().find("."));
+            {
+                const ByteView body = tlv.get_body();
+                StationName  = std::string(body.begin(), std::find(body.begin(), body.end(), '.'));
                 break;
+            }
             
             default:
                 break;
@@ -423,68 +639,192 @@ void profinet::DCP_Device::add_TLV(TLV tlv)
 };
 
 /// \brief Parse a captured PN-DCP reply buffer and return a DCP_Device.
+/// \details The MAC is the Ethernet source address. The blocks are read in place through a
+/// TLVCursor; only the strings kept by the device are copied. Ethernet padding after the
+/// block list is ignored.
 std::optional<profinet::DCP_Device> profinet::DCP_Device::create(int len,const u_char* package)
 {
-    
-    std::vector<uint8_t> data(package, package + len);   
-    
-    
+    const int blocks_start = 26;
+    if(len < blocks_start) return std::nullopt;
 
-    int tlvs_len = static_cast<int>((data[24] << 8) | data[25]);
-    int starting_block = len-tlvs_len;
+    if(package[12] != 0x88 || package[13] != 0x92) return std::nullopt;
 
-    if(starting_block!=26)return std::nullopt;
-
-	std::vector<uint8_t> tlvs(data.begin()+starting_block,data.begin()+starting_block+tlvs_len);
+    const size_t tlvs_len = (static_cast<size_t>(package[24]) << 8) | package[25];
+    if(blocks_start + tlvs_len > static_cast<size_t>(len)) return std::nullopt;
 
     auto self = profinet::DCP_Device();
-	while( tlvs.size()>0)
+    char mac[18];
+    std::snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x",
+                  package[6], package[7], package[8], package[9], package[10], package[11]);
+    self.MAC = std::string(mac);
+
+    TLVCursor cursor(ByteView{package + blocks_start, tlvs_len});
+    while(auto tlv = cursor.next()) self.add_TLV(*tlv);
+
+    if(cursor.failed())
     {
-		std::optional<TLV> tlv =TLV::create(tlvs);
-		if(tlv.has_value())
-        {    
-            int padding = static_cast<int>(tlv.value().get_len())  %2 == 0  ? 0 : 1;
-            tlvs.erase(tlvs.begin(),tlvs.begin()+4+tlv.value().get_len()+padding);
-            if(tlv.has_value()) self.add_TLV(tlv.value());
-        }
-        else
-        {
-            std::cerr<<"Something wrong on tlv creation";
-            return std::nullopt;
-        }
+        std::cerr<<"Something wrong on tlv creation\n";
+        return std::nullopt;
     }
-
     return self;
 }
 
 /* ---------------- TLV ---------------- */
 
 /// \brief Simple TLV constructor.
-profinet::TLV::TLV(uint8_t opt, uint8_t sub_opt,int len)
-    :option(opt),sub_option(sub_opt),len(len){};
+profinet::TLV::TLV(uint8_t opt, uint8_t sub_opt,int len,ByteView body)
+    :option(opt),sub_option(sub_opt),len(len),body(body){};
         
 /// \brief Return TLV Option.
-uint8_t profinet::TLV::get_option(){return option;}
+uint8_t profinet::TLV::get_option()const{return option;}
 
 /// \brief Return TLV Sub-Option.
-uint8_t profinet::TLV::get_suboption(){return sub_option;}
+uint8_t profinet::TLV::get_suboption()const{return sub_option;}
 
-/// \brief Return TLV body length.
-int profinet::TLV::get_len(){return len;}
+/// \brief Return TLV block length (BlockInfo included).
+int profinet::TLV::get_len()const{return len;}
         
-/// \brief Return TLV body parse in bytes.
-const std::vector<uint8_t>& profinet::TLV::get_body(){ return body; }
+/// \brief Return TLV body, BlockInfo excluded.
+profinet::ByteView profinet::TLV::get_body()const{ return body; }
+
+/* ---------------- TLV Cursor ---------------- */
 
-/// \brief Parse a TLV from a vector of byte.
-std::optional<profinet::TLV> profinet::TLV::create(std::vector<uint8_t>& bt)
+/// \brief Cursor at the first block of \p blocks.
+profinet::TLVCursor::TLVCursor(ByteView blocks)
+    :pos(blocks.begin()),end(blocks.end()){}
+
+/// \brief Reads the block at the cursor and moves past it (and its odd-length padding).
+std::optional<profinet::TLV> profinet::TLVCursor::next()
 {
-    if(bt.size() < 4)return std::nullopt;
-    
-    int L = (static_cast<int>(bt[2]) << 8) | bt[3];
-    
-    TLV self = TLV(bt[0],bt[1],L);
-    
-    self.body.assign(bt.begin() + 6, bt.begin() + 4 + L);
+    if(error || pos == end) return std::nullopt;
+    if(end - pos < 4) { error = true; return std::nullopt; }
 
-    return self;
+    const size_t L = (static_cast<size_t>(pos[2]) << 8) | pos[3];
+    if(static_cast<size_t>(end - pos) - 4 < L) { error = true; return std::nullopt; }
+
+    ByteView body{};
+    if(L >= 2) body = ByteView{pos + 6, L - 2};
+    TLV tlv(pos[0], pos[1], static_cast<int>(L), body);
+
+    const size_t step = 4 + L + (L % 2);
+    pos = static_cast<size_t>(end - pos) > step ? pos + step : end;
+    return tlv;
+}
+
+/// \brief True if the walk stopped on a truncated block.
+bool profinet::TLVCursor::failed()const{ return error; }
+
+/* ---------------- Benchmark ---------------- */
+
+/// \brief Loads the frames of \p pcap_path, then parses them in a loop for about one second.
+/// \details Measures DCP_Device::create alone (no capture, no queue), e.g. on a set of
+/// Identify responses saved with Wireshark. The replay fails if devices were dropped or,
+/// when \p expected is not negative, if the table does not list exactly that many.
+int profinet::bench_parser(const std::string& pcap_path,long expected)
+{
+    char errbuf[PCAP_ERRBUF_SIZE];
+    pcap_t* file = pcap_open_offline(pcap_path.c_str(), errbuf);
+    if(file == nullptr)
+    {
+        std::cerr<<"Cannot open "<<pcap_path<<": "<<errbuf<<"\n";
+        return 1;
+    }
+
+    std::vector<std::vector<u_char>> frames;
+    pcap_pkthdr* h = nullptr;
+    const u_char* bytes = nullptr;
+    while(pcap_next_ex(file, &h, &bytes) == 1) frames.emplace_back(bytes, bytes + h->caplen);
+    pcap_close(file);
+    if(frames.empty())
+    {
+        std::cerr<<"No frames in "<<pcap_path<<"\n";
+        return 1;
+    }
+
+    size_t parsed = 0, devices = 0;
+    const auto start = steady_clock::now();
+    auto elapsed = steady_clock::duration::zero();
+    while(elapsed < seconds(1))
+    {
+        for(const auto& f : frames)
+            if(DCP_Device::create(static_cast<int>(f.size()), f.data()).has_value()) ++devices;
+        parsed += frames.size();
+        elapsed = steady_clock::now() - start;
+    }
+
+    const double s = duration<double>(elapsed).count();
+    std::cout<<frames.size()<<" frames, "<<devices * frames.size() / parsed<<" DCP replies; "
+             <<static_cast<long long>(parsed / s)<<" frames/s\n";
+
+    // Same path as a scan: pcap_dispatch -> PackageParser -> DeviceQueue -> DeviceTable.
+    file = pcap_open_offline(pcap_path.c_str(), errbuf);
+    if(file == nullptr) return 1;
+    DeviceQueue queue;
+    DeviceTable table;
+    PackageParser parser(&queue, file);
+    DCP_Device dev;
+    const auto replay_start = steady_clock::now();
+    while(parser.start() > 0)
+        while(queue.pop(dev)) table.upsert(std::move(dev));
+    const size_t listed = table.get_rows().size();
+    const double replay_s = duration<double>(steady_clock::now() - replay_start).count();
+    pcap_close(file);
+
+    std::cout<<"replay: "<<static_cast<long long>(frames.size() / replay_s)<<" frames/s, "
+             <<listed<<" devices\n";
+
+    if(parser.get_dropped() != 0)
+    {
+        std::cerr<<"replay dropped "<<parser.get_dropped()<<" devices\n";
+        return 1;
+    }
+    if(expected >= 0 && listed != static_cast<size_t>(expected))
+    {
+        std::cerr<<"replay listed "<<listed<<" devices, expected "<<expected<<"\n";
+        return 1;
+    }
+    return 0;
+}
+
+/// \brief Writes one Identify response per synthetic PLC to \p pcap_path (Ethernet link
+/// type), for bench_parser() or PcapClient::replay() without hardware.
+/// \details Device i gets MAC 00:1b:1b:xx:xx:xx and IP 10.x.x.x derived from i, station
+/// name "plc-<i>" and an S7-1500 or S7-1200 family.
+int profinet::write_fleet(const std::string& pcap_path,int count)
+{
+    if(count < 1 || count > max_fleet)
+    {
+        std::cerr<<"Fleet size must be between 1 and "<<max_fleet<<", got "<<count<<"\n";
+        return 1;
+    }
+
+    pcap_t* dead = pcap_open_dead(DLT_EN10MB, 65535);
+    pcap_dumper_t* out = dead != nullptr ? pcap_dump_open(dead, pcap_path.c_str()) : nullptr;
+    if(out == nullptr)
+    {
+        std::cerr<<"Cannot write "<<pcap_path<<": "<<(dead != nullptr ? pcap_geterr(dead) : "no pcap handle")<<"\n";
+        if(dead != nullptr) pcap_close(dead);
+        return 1;
+    }
+
+    const std::array<uint8_t,4> XID{0x12, 0x34, 0x56, 0x78};
+    const auto stamp = system_clock::now().time_since_epoch();
+    for(int i = 0; i < count; ++i)
+    {
+        const uint8_t b2 = static_cast<uint8_t>(i >> 16), b1 = static_cast<uint8_t>(i >> 8), b0 = static_cast<uint8_t>(i);
+        auto frame = packageHelper::build_DCP_response({0x00, 0x1b, 0x1b, b2, b1, b0}, XID,
+                                                       i % 2 == 0 ? "S7-1500" : "S7-1200",
+                                                       "plc-" + std::to_string(i), {10, b2, b1, b0});
+        pcap_pkthdr h{};
+        const auto t = duration_cast<microseconds>(stamp) + microseconds(i * 10);
+        h.ts.tv_sec = static_cast<decltype(h.ts.tv_sec)>(t.count() / 1000000);
+        h.ts.tv_usec = static_cast<decltype(h.ts.tv_usec)>(t.count() % 1000000);
+        h.caplen = h.len = static_cast<bpf_u_int32>(frame.size());
+        pcap_dump(reinterpret_cast<u_char*>(out), &h, frame.data());
+    }
+
+    pcap_dump_close(out);
+    pcap_close(dead);
+    std::cout<<"wrote "<<count<<" DCP responses to "<<pcap_path<<"\n";
+    return 0;
 }
@@ -0,0 +1,110 @@
+#include <read_planner.hpp>
+#include <classes.hpp>
+
+/// \brief PDU used when the session did not report one (S7-300 default).
+static constexpr int fallback_pdu = 240;
+
+/// \brief Largest data block a single response item can carry.
+int read_planner::max_item_payload(int pdu_length)
+{
+    if (pdu_length <= response_header + response_item) pdu_length = fallback_pdu;
+    return pdu_length - response_header - response_item;
+}
+
+/// \brief Byte range occupied by a leaf; bool leaves occupy the byte that holds their bit.
+ByteRange read_planner::field_range(const BASE& leaf)
+{
+    return {leaf.get_offset().first, std::max(leaf.get_size().first, 1)};
+}
+
+/// \brief Appends the byte range of every leaf below \p el to \p out.
+/// \details UDT arrays are covered through their prototype, shifted by the stride for each
+/// index, whether their elements are materialized or not.
+void read_planner::collect_fields(const VariantElement& el,std::vector<ByteRange>& out)
+{
+    std::visit([&](auto&& ptr) {
+        using T = std::decay_t<decltype(*ptr)>;
+        if constexpr (std::is_base_of_v<BASE, T>) {
+            out.push_back(field_range(*ptr));
+        }
+        else if constexpr (std::is_same_v<T, UDT_ARRAY>) {
+            if (ptr->get_prototype() == nullptr) return;
+            std::vector<ByteRange> element;
+            collect_fields(ptr->get_prototype(), element);
+            element = merge(std::move(element), 0);
+
+            for (int i = 0; i < ptr->get_count(); ++i) {
+                int at = ptr->get_base().first + i * ptr->get_stride();
+                for (const auto& r : element) out.push_back({at + r.start, r.size});
+            }
+        }
+        else if constexpr (std::is_base_of_v<BASE_CONTAINER, T>) {
+            for (const auto& ch : ptr->get_childs()) collect_fields(ch, out);
+        }
+    }, el);
+}
+
+/// \brief Byte ranges of all leaves of \p db, in layout order.
+std::vector<ByteRange> read_planner::collect_fields(const std::shared_ptr<DB>& db)
+{
+    std::vector<ByteRange> out;
+    if (db == nullptr) return out;
+    for (const auto& ch : db->get_childs()) collect_fields(ch, out);
+    return out;
+}
+
+/// \brief Sorts and coalesces field ranges, bridging gaps of at most \p merge_gap bytes.
+std::vector<ByteRange> read_planner::merge(std::vector<ByteRange> fields,int merge_gap)
+{
+    std::sort(fields.begin(), fields.end(),
+        [](const ByteRange& a, const ByteRange& b) { return a.start < b.start; });
+
+    std::vector<ByteRange> out;
+    for (const auto& f : fields) {
+        if (f.size <= 0) continue;
+        if (!out.empty() && f.start <= out.back().end() + merge_gap)
+            out.back().size = std::max(out.back().end(), f.end()) - out.back().start;
+        else
+            out.push_back(f);
+    }
+    return out;
+}
+
+/// \brief Splits merged ranges to the PDU and packs them into ReadMultiVars batches.
+/// \param merged Output of merge() (sorted, non overlapping).
+/// \param pdu_length Negotiated PDU length of the session.
+/// \param max_items Item limit of one ReadMultiVars call.
+ReadPlan read_planner::plan(const std::vector<ByteRange>& merged,int pdu_length,int max_items)
+{
+    if (pdu_length <= response_header + response_item) pdu_length = fallback_pdu;
+    int request_limit = (pdu_length - request_header) / request_item;
+    size_t item_limit = static_cast<size_t>(std::max(1, std::min(max_items, request_limit)));
+
+    ReadPlan out;
+    ReadBatch cur;
+    int used = response_header;
+
+    auto flush = [&]() {
+        if (!cur.items.empty()) out.batches.push_back(std::move(cur));
+        cur = ReadBatch();
+        used = response_header;
+    };
+
+    for (ByteRange r : merged) {
+        while (r.size > 0) {
+            int room = pdu_length - used - response_item;
+            if (cur.items.size() >= item_limit || room <= 0) {
+                flush();
+                continue;
+            }
+            int chunk = std::min(r.size, room);
+            cur.items.push_back({r.start, chunk});
+            used += response_item + chunk + (chunk & 1);
+            out.total_bytes += chunk;
+            r.start += chunk;
+            r.size -= chunk;
+        }
+    }
+    flush();
+    return out;
+}
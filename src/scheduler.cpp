@@ -0,0 +1,206 @@
+#include <scheduler.hpp>
+
+using namespace std::chrono;
+
+/// \brief Weight of the newest sample in the achieved cycle moving average.
+static constexpr double cycle_alpha = 0.2;
+
+/// \brief Minimum retry period of a job whose last cycle failed, so unreachable CPUs
+/// do not keep workers busy with back-to-back connection timeouts.
+static constexpr milliseconds error_backoff{2000};
+
+/// \brief Milliseconds between two time points.
+static double span_ms(steady_clock::time_point from,steady_clock::time_point to)
+{
+    return duration<double,std::milli>(to - from).count();
+}
+
+/// \brief Starts \p worker_count worker threads sharing the connection pool.
+AcquisitionScheduler::AcquisitionScheduler(ConnectionPool* pool_in,unsigned worker_count)
+    : pool(pool_in)
+{
+    if (worker_count == 0) worker_count = 1;
+    for (unsigned i = 0; i < worker_count; ++i)
+        workers.emplace_back(&AcquisitionScheduler::_worker, this);
+}
+
+/// \brief Stops and joins all workers; in-flight reads complete first.
+AcquisitionScheduler::~AcquisitionScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        stop_requested = true;
+    }
+    cv.notify_all();
+    for (auto& w : workers) if (w.joinable()) w.join();
+}
+
+/// \brief Adds a job, or replaces the job already registered for the same PLC.
+/// \details The first cycle is due immediately.
+void AcquisitionScheduler::add(const PlcJobConfig& cfg)
+{
+    auto job = std::make_shared<Job>();
+    job->cfg = cfg;
+    if (job->cfg.cycle.count() <= 0) job->cfg.cycle = milliseconds(1);
+    job->deadline = clock::now();
+    job->stats.key = cfg.key;
+    job->stats.requested_ms = static_cast<double>(job->cfg.cycle.count());
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        auto it = jobs.find(cfg.key);
+        if (it != jobs.end()) it->second->removed = true;
+        jobs[cfg.key] = job;
+        ready.push({job->deadline, job});
+    }
+    cv.notify_all();
+}
+
+/// \brief Removes the job of \p key; a read in progress finishes but is not rescheduled.
+void AcquisitionScheduler::remove(const PlcKey& key)
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    auto it = jobs.find(key);
+    if (it == jobs.end()) return;
+    it->second->removed = true;
+    jobs.erase(it);
+}
+
+/// \brief Removes every job.
+void AcquisitionScheduler::clear()
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    for (auto& [key, job] : jobs) job->removed = true;
+    jobs.clear();
+}
+
+/// \brief Number of registered jobs.
+size_t AcquisitionScheduler::size()
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    return jobs.size();
+}
+
+/// \brief True if a job is registered for \p key.
+bool AcquisitionScheduler::has(const PlcKey& key)
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    return jobs.count(key) != 0;
+}
+
+/// \brief Requested vs. achieved cycle of every job, ordered by PLC key.
+std::vector<PlcCycleStats> AcquisitionScheduler::get_stats()
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    std::vector<PlcCycleStats> out;
+    out.reserve(jobs.size());
+    for (auto& [key, job] : jobs) out.push_back(job->stats);
+    return out;
+}
+
+/// \brief Newest snapshot of \p key since the last call, or nullptr. Single consumer thread only.
+const PlcSnapshot* AcquisitionScheduler::fetch(const PlcKey& key)
+{
+    std::shared_ptr<Job> job;
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        auto it = jobs.find(key);
+        if (it == jobs.end()) return nullptr;
+        job = it->second;
+    }
+    return job->handoff.fetch();
+}
+
+/// \brief Worker loop: takes the job with the earliest deadline once it is due.
+void AcquisitionScheduler::_worker()
+{
+    std::unique_lock<std::mutex> lk(mtx);
+    while (!stop_requested)
+    {
+        if (ready.empty()) {
+            cv.wait(lk);
+            continue;
+        }
+        Ready top = ready.top();
+        if (top.job->removed) {
+            ready.pop();
+            continue;
+        }
+        if (clock::now() < top.deadline) {
+            cv.wait_until(lk, top.deadline);
+            continue;
+        }
+        ready.pop();
+        std::shared_ptr<Job> job = top.job;
+        lk.unlock();
+
+        auto start = clock::now();
+        _run_job(*job, start);
+        auto end = clock::now();
+
+        lk.lock();
+        PlcCycleStats& st = job->stats;
+        st.last_duration_ms = span_ms(start, end);
+        st.max_lateness_ms = std::max(st.max_lateness_ms, span_ms(job->deadline, start));
+        if (job->last_start != clock::time_point{}) {
+            double interval = span_ms(job->last_start, start);
+            st.achieved_ms = st.cycles <= 1 ? interval : st.achieved_ms + cycle_alpha * (interval - st.achieved_ms);
+        }
+        job->last_start = start;
+        ++st.cycles;
+
+        job->deadline += job->cfg.cycle;
+        if (job->deadline < end) {
+            ++st.overruns;
+            auto missed = (end - job->deadline) / job->cfg.cycle + 1;
+            job->deadline += job->cfg.cycle * missed;
+        }
+        if (st.last_result != 0)
+            job->deadline = std::max(job->deadline, end + std::max<milliseconds>(job->cfg.cycle, error_backoff));
+
+        if (!job->removed) {
+            ready.push({job->deadline, job});
+            cv.notify_one();
+        }
+    }
+}
+
+/// \brief Reads all DBs of \p job through its pooled session and publishes the images.
+/// \details Runs without the scheduler lock; a job is executed by one worker at a time.
+void AcquisitionScheduler::_run_job(Job& job,clock::time_point start)
+{
+    PlcSnapshot& snap = job.handoff.write_slot();
+    snap.key = job.cfg.key;
+    snap.dbs.resize(job.cfg.dbs.size());
+
+    auto conn = pool->acquire(job.cfg.key);
+    int worst = 0;
+    double cycle_ms = job.last_start == clock::time_point{} ? 0.0 : span_ms(job.last_start, start);
+
+    for (size_t i = 0; i < job.cfg.dbs.size(); ++i)
+    {
+        const DbRequest& req = job.cfg.dbs[i];
+        DbSnapshot& d = snap.dbs[i];
+        d.buffer.resize(req.size);
+        if (req.ranges && !req.ranges->empty() && req.ranges->back().end() > req.size)
+            d.buffer.resize(req.ranges->back().end());
+
+        auto t0 = clock::now();
+        d.result = req.ranges
+            ? conn->read_ranges(req.db_nr, *req.ranges, d.buffer.data())
+            : conn->read(req.db_nr, 0, req.size, d.buffer.data());
+        d.read_ms = span_ms(t0, clock::now());
+        d.key = job.cfg.key;
+        d.db_nr = req.db_nr;
+        d.ranges = req.ranges;
+        d.stamp = t0;
+        d.cycle_ms = cycle_ms;
+        d.seq = job.seq + 1;
+        if (d.result != 0) worst = d.result;
+    }
+    snap.seq = ++job.seq;
+    job.handoff.publish();
+
+    std::lock_guard<std::mutex> lk(mtx);
+    job.stats.last_result = worst;
+    if (worst != 0) ++job.stats.errors;
+}
@@ -0,0 +1,536 @@
+#include <search_index.hpp>
+#include <tree_walk.hpp>
+#include <type_readers.hpp>
+#include <type_traits>
+#include <unordered_map>
+#include <chrono>
+
+using namespace std::chrono;
+
+/// \brief Checks for cancellation once per this many leaves.
+static constexpr std::size_t cancel_check_every = 1024;
+
+/// \brief Case folding used for the index and the needles alike.
+static inline char fold(char c)
+{
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+/// \brief Folded copy of \p s.
+static std::string folded(std::string_view s)
+{
+    std::string out(s);
+    for (char& c : out) c = fold(c);
+    return out;
+}
+
+/// \brief Posting key of the trigram at \p p.
+static inline std::uint32_t trigram_key(const char* p)
+{
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(p[0])) << 16 |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(p[1])) << 8 |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(p[2]));
+}
+
+/// \brief Case-insensitive substring test without copying \p haystack.
+/// \param needle Already folded; an empty needle never matches.
+static bool icontains(std::string_view haystack,std::string_view needle)
+{
+    if (needle.empty() || needle.size() > haystack.size()) return false;
+
+    const std::size_t last = haystack.size() - needle.size();
+    for (std::size_t i = 0; i <= last; ++i) {
+        std::size_t j = 0;
+        while (j < needle.size() && fold(haystack[i + j]) == needle[j]) ++j;
+        if (j == needle.size()) return true;
+    }
+    return false;
+}
+
+template <class T>
+static constexpr bool is_number_v = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+/// \brief Equality across the numeric alternatives of Value.
+/// \details Integers compare exactly, whatever their signedness; a float leaf matches a
+/// needle that rounds to it (typing "0.1" finds a Real holding 0.1f).
+template <class A,class B>
+static bool numbers_equal(A a,B b)
+{
+    if constexpr (std::is_integral_v<A> && std::is_integral_v<B>) {
+        if constexpr (std::is_signed_v<A> != std::is_signed_v<B>) {
+            if ((std::is_signed_v<A> && a < 0) || (std::is_signed_v<B> && b < 0)) return false;
+        }
+        return static_cast<std::uint64_t>(a) == static_cast<std::uint64_t>(b);
+    }
+    else if constexpr (std::is_same_v<A, float>) {
+        return a == static_cast<float>(b);
+    }
+    else {
+        return static_cast<double>(a) == static_cast<double>(b);
+    }
+}
+
+/// \brief Value rules of the filter: strings and times by substring, numbers by equality.
+/// \param needle Filter value, strings already folded.
+static bool value_matches(const Value& value,const Value& needle)
+{
+    return std::visit(overloaded{
+        [](const std::string& a, const std::string& b) { return icontains(a, b); },
+        [](const TimeValue& a, const std::string& b)   { return icontains(tia::to_string(a), b); },
+        [](bool a, bool b) { return a && b; },
+        [](auto const& a, auto const& b) {
+            using A = std::decay_t<decltype(a)>;
+            using B = std::decay_t<decltype(b)>;
+            if constexpr (is_number_v<A> && is_number_v<B>) return numbers_equal(a, b);
+            else return false;
+        }
+    }, value, needle);
+}
+
+/// \brief True for the containers whose children carry the index in their own name.
+static bool is_array(const VariantElement& el)
+{
+    return std::holds_alternative<std::shared_ptr<STD_ARRAY>>(el) ||
+           std::holds_alternative<std::shared_ptr<UDT_ARRAY>>(el) ||
+           std::holds_alternative<std::shared_ptr<STRUCT_ARRAY>>(el);
+}
+
+/// \brief Flattens the whole tree of \p db. GUI thread only.
+/// \details The materialized elements of a UDT array are skipped: the array gets the nodes
+/// of every index from its prototype instead (see _capture_array()).
+std::shared_ptr<Filter::SearchIndex> Filter::SearchIndex::capture(const std::shared_ptr<DB>& db)
+{
+    auto idx = std::make_shared<SearchIndex>();
+    std::vector<int> open;      // Containers whose children are being captured.
+
+    tree_walk::walk(db->get_childs(),
+        [&](const VariantElement& el) {
+            const int parent = open.empty() ? -1 : open.back();
+            return std::visit([&](const auto& ptr) {
+                using E = std::decay_t<decltype(*ptr)>;
+                const int node = idx->_add_node(&el, parent, &ptr->get_name(), is_array(el), -1);
+                if constexpr (std::is_base_of_v<BASE, E>) {
+                    idx->leaf_nodes.push_back(static_cast<std::uint32_t>(node));
+                    idx->comments.push_back(&ptr->get_comment());
+                    idx->record_of.push_back(-1);
+                }
+                else if constexpr (std::is_same_v<E, UDT_ARRAY>) {
+                    idx->_capture_array(*ptr, node, 0);
+                    return false;
+                }
+                else open.push_back(node);
+                return true;
+            }, el);
+        },
+        [&](const VariantElement&) { open.pop_back(); });
+
+    return idx;
+}
+
+/// \brief Appends a node under \p parent.
+/// \param el Element of the tree, nullptr for a node under a UDT array.
+int Filter::SearchIndex::_add_node(const VariantElement* el,int parent,const std::string* name,bool array,int slot)
+{
+    const int node = static_cast<int>(elements.size());
+    elements.push_back(el);
+    parents.push_back(parent);
+    // "Arr[3]" already names its array: the path skips the array node.
+    path_parents.push_back(parent >= 0 && arrays[parent] ? path_parents[parent] : parent);
+    arrays.push_back(array);
+    slots.push_back(slot);
+    names.push_back(name);
+    return node;
+}
+
+/// \brief Adds one node per index of \p arr under \p node, each with the prototype nodes.
+/// \param shift Byte offset the offsets of \p arr are relative to (0 in the DB, the
+/// element start inside a prototype).
+void Filter::SearchIndex::_capture_array(const UDT_ARRAY& arr,int node,std::uint32_t shift)
+{
+    const auto proto = arr.get_prototype();
+    if (proto == nullptr) return;
+
+    for (int i = arr.get_start(); i <= arr.get_end(); ++i) {
+        element_names.push_back(arr.get_name() + "[" + std::to_string(i) + "]");
+        const int el = _add_node(nullptr, node, &element_names.back(), false, i);
+        const auto start = static_cast<std::uint32_t>(arr.get_base().first + (i - arr.get_start()) * arr.get_stride());
+        _capture_childs(proto->get_childs(), el, shift + start);
+    }
+}
+
+/// \brief Adds the prototype nodes \p childs under \p parent, their leaves at \p shift.
+void Filter::SearchIndex::_capture_childs(const std::vector<VariantElement>& childs,int parent,std::uint32_t shift)
+{
+    for (std::size_t k = 0; k < childs.size(); ++k) {
+        std::visit([&](const auto& ptr) {
+            using E = std::decay_t<decltype(*ptr)>;
+            const int node = _add_node(nullptr, parent, &ptr->get_name(), is_array(childs[k]), static_cast<int>(k));
+            if constexpr (std::is_base_of_v<BASE, E>) {
+                LeafRecord rec;
+                rec.offset = shift + static_cast<std::uint32_t>(ptr->get_offset().first);
+                rec.bit = static_cast<std::uint8_t>(ptr->get_offset().second);
+                rec.type = ptr->get_type_code();
+                rec.len = static_cast<std::uint16_t>(ptr->get_size().first);
+                rec.id = static_cast<std::uint32_t>(leaf_nodes.size());
+
+                leaf_nodes.push_back(static_cast<std::uint32_t>(node));
+                comments.push_back(&ptr->get_comment());
+                record_of.push_back(static_cast<int>(records.size()));
+                records.push_back(rec);
+            }
+            else if constexpr (std::is_same_v<E, UDT_ARRAY>) _capture_array(*ptr, node, shift);
+            else _capture_childs(ptr->get_childs(), node, shift);
+        }, childs[k]);
+    }
+}
+
+/// \brief Index of \p db, captured on first use and cached on the DB. GUI thread only.
+std::shared_ptr<Filter::SearchIndex> Filter::SearchIndex::of(const std::shared_ptr<DB>& db)
+{
+    if (const auto& idx = db->get_search_index()) return idx;
+    auto idx = capture(db);
+    db->set_search_index(idx);
+    return idx;
+}
+
+/// \brief Folds the texts and fills the posting lists; the first call does the work.
+void Filter::SearchIndex::build()
+{
+    std::call_once(built, [this] { _build(); });
+}
+
+void Filter::SearchIndex::_build()
+{
+    const auto start = steady_clock::now();
+    const std::size_t leaves = leaf_nodes.size();
+
+    auto append = [&](std::string_view s) {
+        Span span{static_cast<std::uint32_t>(text.size()), static_cast<std::uint32_t>(s.size())};
+        for (char c : s) text.push_back(fold(c));
+        return span;
+    };
+
+    // Names and comments are pooled, so equal strings have the same address.
+    std::unordered_map<const std::string*, std::uint32_t> ids;
+    auto intern = [&](const std::string* s) {
+        auto [it, inserted] = ids.emplace(s, static_cast<std::uint32_t>(strings.size()));
+        if (inserted) strings.push_back(append(*s));
+        return it->second;
+    };
+
+    name_ids.reserve(leaves);
+    comment_ids.reserve(leaves);
+    paths.reserve(leaves);
+    std::vector<int> chain;
+    for (std::size_t leaf = 0; leaf < leaves; ++leaf) {
+        const int node = static_cast<int>(leaf_nodes[leaf]);
+        name_ids.push_back(intern(names[node]));
+        comment_ids.push_back(intern(comments[leaf]));
+
+        chain.clear();
+        for (int n = node; n >= 0; n = path_parents[n]) chain.push_back(n);
+        Span path{static_cast<std::uint32_t>(text.size()), 0};
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            if (it != chain.rbegin()) text.push_back('.');
+            append(*names[*it]);
+        }
+        path.size = static_cast<std::uint32_t>(text.size() - path.offset);
+        paths.push_back(path);
+    }
+
+    string_grams.fill(text, strings);
+    path_grams.fill(text, paths);
+
+    build_ms = duration<double,std::milli>(steady_clock::now() - start).count();
+}
+
+/// \brief Indexes the trigrams of every span of \p text.
+/// \details Spans are visited in order, so every list comes out sorted; a span is added
+/// once per trigram even if the trigram repeats in its text.
+void Filter::SearchIndex::Postings::fill(const std::string& text,const std::vector<Span>& spans)
+{
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> lists;
+    for (std::uint32_t id = 0; id < spans.size(); ++id) {
+        const Span span = spans[id];
+        for (std::uint32_t i = 0; i + 3 <= span.size; ++i) {
+            auto& list = lists[trigram_key(text.data() + span.offset + i)];
+            if (list.empty() || list.back() != id) list.push_back(id);
+        }
+    }
+
+    keys.reserve(lists.size());
+    for (const auto& entry : lists) keys.push_back(entry.first);
+    std::sort(keys.begin(), keys.end());
+
+    starts.reserve(keys.size() + 1);
+    for (std::uint32_t key : keys) {
+        const auto& list = lists[key];
+        starts.push_back(static_cast<std::uint32_t>(ids.size()));
+        ids.insert(ids.end(), list.begin(), list.end());
+    }
+    starts.push_back(static_cast<std::uint32_t>(ids.size()));
+}
+
+/// \brief Posting list of \p key, nullptr if no span contains it.
+const std::uint32_t* Filter::SearchIndex::Postings::find(std::uint32_t key,std::size_t& count)const
+{
+    auto it = std::lower_bound(keys.begin(), keys.end(), key);
+    if (it == keys.end() || *it != key) return nullptr;
+    const std::size_t k = static_cast<std::size_t>(it - keys.begin());
+    count = starts[k + 1] - starts[k];
+    return ids.data() + starts[k];
+}
+
+/// \brief Spans containing every trigram of \p needle (at least 3 chars).
+/// \details Intersects the lists from the shortest one, so the work is bounded by the
+/// rarest trigram; the candidates still have to be verified.
+void Filter::SearchIndex::Postings::candidates(std::string_view needle,std::vector<std::uint32_t>& out)const
+{
+    struct List { const std::uint32_t* data; std::size_t count; };
+    std::vector<List> lists;
+
+    for (std::size_t i = 0; i + 3 <= needle.size(); ++i) {
+        std::size_t count = 0;
+        const std::uint32_t* data = find(trigram_key(needle.data() + i), count);
+        if (data == nullptr) { out.clear(); return; }
+        lists.push_back({data, count});
+    }
+    std::sort(lists.begin(), lists.end(), [](const List& a, const List& b) {
+        return a.count != b.count ? a.count < b.count : a.data < b.data;
+    });
+    lists.erase(std::unique(lists.begin(), lists.end(), [](const List& a, const List& b) { return a.data == b.data; }),
+                lists.end());
+
+    out.assign(lists[0].data, lists[0].data + lists[0].count);
+    for (std::size_t l = 1; l < lists.size() && !out.empty(); ++l) {
+        const std::uint32_t* p = lists[l].data;
+        const std::uint32_t* end = p + lists[l].count;
+
+        // Galloping search: both lists are sorted, so each lookup starts where the last one
+        // ended and costs O(log gap) instead of O(log size).
+        std::size_t kept = 0;
+        for (std::uint32_t id : out) {
+            std::size_t step = 1;
+            while (p + step < end && p[step] < id) step *= 2;
+            p = std::lower_bound(p + step / 2, std::min(p + step + 1, end), id);
+            if (p == end) break;
+            if (*p == id) out[kept++] = id;
+        }
+        out.resize(kept);
+    }
+}
+
+/// \brief Flags the distinct strings containing \p needle (folded, not empty).
+/// \return false if none does.
+bool Filter::SearchIndex::_match_strings(std::string_view needle,std::vector<char>& hits)const
+{
+    hits.assign(strings.size(), 0);
+    bool any = false;
+    auto check = [&](std::uint32_t id) {
+        hits[id] = _text(strings[id]).find(needle) != std::string_view::npos;
+        any = any || hits[id];
+    };
+
+    if (needle.size() < 3) {
+        for (std::uint32_t id = 0; id < strings.size(); ++id) check(id);
+        return any;
+    }
+
+    std::vector<std::uint32_t> candidates;
+    string_grams.candidates(needle, candidates);
+    for (std::uint32_t id : candidates) check(id);
+    return any;
+}
+
+/// \brief Folded text of \p span.
+std::string_view Filter::SearchIndex::_text(Span span)const
+{
+    return std::string_view(text.data() + span.offset, span.size);
+}
+
+/// \brief Current value of every leaf, in leaf order. GUI thread only.
+/// \details Leaves under a UDT array are decoded from the last buffer of \p db; those it
+/// does not cover get an empty string, which no value filter matches.
+std::vector<Value> Filter::SearchIndex::capture_values(const DB& db)const
+{
+    const auto& buffer = db.get_buffer();
+
+    std::vector<Value> values;
+    values.reserve(leaf_nodes.size());
+    for (std::size_t leaf = 0; leaf < leaf_nodes.size(); ++leaf) {
+        if (record_of[leaf] >= 0) {
+            const LeafRecord& rec = records[record_of[leaf]];
+            if (rec.offset + std::max<std::size_t>(rec.len, 1) <= buffer.size()) values.push_back(translate::decode(rec, buffer));
+            else values.push_back(std::string());
+            continue;
+        }
+        values.push_back(std::visit([](const auto& ptr) -> Value {
+            using E = std::decay_t<decltype(*ptr)>;
+            if constexpr (std::is_base_of_v<BASE, E>) return ptr->get_data();
+            else return Value{};
+        }, *elements[leaf_nodes[leaf]]));
+    }
+    return values;
+}
+
+/// \brief Copies the Bool leaf values of \p db (see DB::get_bool_bits()) into leaf order.
+/// GUI thread only. Leaves under a UDT array are read from the last buffer of \p db.
+/// Leaves not decoded yet count as not Bool.
+Filter::BoolPlane Filter::SearchIndex::capture_bools(const DB& db)const
+{
+    const auto& layout = db.get_layout();
+    const auto& bits = db.get_bool_bits();
+    const auto& buffer = db.get_buffer();
+
+    BoolPlane plane;
+    plane.is_bool.assign((leaf_nodes.size() + 63) / 64, 0);
+    plane.value.assign(plane.is_bool.size(), 0);
+    for (std::size_t leaf = 0; leaf < leaf_nodes.size(); ++leaf) {
+        const std::uint64_t bit = std::uint64_t(1) << (leaf % 64);
+        if (record_of[leaf] >= 0) {
+            const LeafRecord& rec = records[record_of[leaf]];
+            if (rec.type != TiaType::Bool || rec.offset >= buffer.size()) continue;
+            plane.is_bool[leaf / 64] |= bit;
+            if ((buffer[rec.offset] >> rec.bit) & 1) plane.value[leaf / 64] |= bit;
+            continue;
+        }
+
+        const int id = std::visit([](const auto& ptr) {
+            using E = std::decay_t<decltype(*ptr)>;
+            if constexpr (std::is_base_of_v<BASE, E>) return ptr->get_leaf_id();
+            else return -1;
+        }, *elements[leaf_nodes[leaf]]);
+        if (id < 0 || layout[id].type != TiaType::Bool) continue;
+
+        plane.is_bool[leaf / 64] |= bit;
+        if ((bits[id / 64] >> (id % 64)) & 1) plane.value[leaf / 64] |= bit;
+    }
+    return plane;
+}
+
+/// \brief Visibility of every node under filter \p f; build() must have run.
+/// \details A leaf is visible if it matches every criterion: name, comment (substrings,
+/// case-insensitive), value (\p values, from capture_values()) and Bool state (\p bools,
+/// from capture_bools(); only Bool leaves match). A name containing '.'
+/// or '[' is matched against the symbol path. Containers are visible if a descendant is.
+/// \param cancelled Polled while checking the leaves; evaluation stops when it returns true.
+/// \return false if cancelled (\p vis is then incomplete).
+bool Filter::SearchIndex::evaluate(const filterElem& f,const std::vector<Value>* values,const BoolPlane* bools,
+                                   VisBitmap& vis,const std::function<bool()>& cancelled)const
+{
+    vis.assign((elements.size() + 63) / 64, 0);
+
+    // An empty needle never matches.
+    if ((f.name && f.name->empty()) || (f.comment && f.comment->empty())) return true;
+
+    const std::string name = f.name ? folded(*f.name) : std::string();
+    const std::string comment = f.comment ? folded(*f.comment) : std::string();
+    const bool by_path = f.name && name.find_first_of(".[") != std::string::npos;
+
+    std::optional<Value> value;
+    if (f.value_in && values != nullptr) {
+        value = f.value_in;
+        if (auto* s = std::get_if<std::string>(&*value)) *s = folded(*s);
+    }
+
+    const bool by_bool = f.bool_el.has_value() && bools != nullptr;
+
+    // Names and comments are decided once per distinct string.
+    std::vector<char> name_hits, comment_hits;
+    if (f.name && !by_path && !_match_strings(name, name_hits)) return true;
+    if (f.comment && !_match_strings(comment, comment_hits)) return true;
+
+    // Leaves to check: those whose path has every trigram of the needle, or all.
+    std::vector<std::uint32_t> candidates;
+    const bool all = !(by_path && name.size() >= 3);
+    if (!all) path_grams.candidates(name, candidates);
+
+    const std::size_t count = all ? leaf_nodes.size() : candidates.size();
+    for (std::size_t k = 0; k < count; ++k) {
+        if (cancelled && k % cancel_check_every == 0 && cancelled()) return false;
+
+        const std::uint32_t leaf = all ? static_cast<std::uint32_t>(k) : candidates[k];
+        if (!name_hits.empty() && !name_hits[name_ids[leaf]]) continue;
+        if (!comment_hits.empty() && !comment_hits[comment_ids[leaf]]) continue;
+        if (by_path && _text(paths[leaf]).find(name) == std::string_view::npos) continue;
+        if (value && !value_matches((*values)[leaf], *value)) continue;
+        if (by_bool) {
+            const std::uint64_t bit = std::uint64_t(1) << (leaf % 64);
+            if (!(bools->is_bool[leaf / 64] & bit)) continue;
+            if (((bools->value[leaf / 64] & bit) != 0) != *f.bool_el) continue;
+        }
+
+        // Mark the leaf and its ancestors, up to the first one already marked.
+        for (int n = static_cast<int>(leaf_nodes[leaf]); n >= 0; n = parents[n]) {
+            std::uint64_t& word = vis[static_cast<std::size_t>(n) / 64];
+            const std::uint64_t bit = std::uint64_t(1) << (n % 64);
+            if (word & bit) break;
+            word |= bit;
+        }
+    }
+    return true;
+}
+
+/// \brief Writes \p vis to the tree. GUI thread only.
+/// \details A UDT array element is shown or hidden through its array, so the rows of the
+/// elements not materialized follow the filter too; the nodes inside an element are only
+/// set if it is materialized. Call it again with \p previous = nullptr after a
+/// materialization (see class_utils::tree_generation()).
+/// \param previous Bitmap applied last on this index, so that only the nodes that changed
+/// are touched; nullptr sets every node.
+void Filter::SearchIndex::apply(const VisBitmap& vis,const VisBitmap* previous)const
+{
+    // Tree element of every node under a UDT array; null if its element is not materialized.
+    std::vector<VariantElement> found;
+    if (!element_names.empty()) {
+        found.resize(elements.size());
+        for (std::size_t n = 0; n < elements.size(); ++n) {
+            if (elements[n] != nullptr) continue;
+            const int p = parents[n];
+            const VariantElement& parent = elements[p] != nullptr ? *elements[p] : found[p];
+            if (auto* arr = std::get_if<std::shared_ptr<UDT_ARRAY>>(&parent)) {
+                if (auto el = (*arr)->find_element(slots[n])) found[n] = el;
+            }
+            else if (const auto* childs = tree_walk::childs_of(parent); childs != nullptr && slots[n] < static_cast<int>(childs->size()))
+                found[n] = (*childs)[slots[n]];
+        }
+    }
+
+    for (std::size_t w = 0; w < vis.size(); ++w) {
+        std::uint64_t diff = previous != nullptr ? vis[w] ^ (*previous)[w] : ~std::uint64_t(0);
+        for (std::size_t n = w * 64; diff != 0 && n < elements.size(); ++n, diff >>= 1) {
+            if (!(diff & 1)) continue;
+            const bool on = (vis[w] >> (n % 64)) & 1;
+            const VariantElement& el = elements[n] != nullptr ? *elements[n] : found[n];
+            std::visit([on](const auto& ptr) { if (ptr != nullptr) ptr->set_vis(on); }, el);
+
+            // Element of a UDT array: its row is hidden through the array.
+            const int p = parents[n];
+            if (elements[n] == nullptr && p >= 0) {
+                const VariantElement& parent = elements[p] != nullptr ? *elements[p] : found[p];
+                if (auto* arr = std::get_if<std::shared_ptr<UDT_ARRAY>>(&parent))
+                    (*arr)->set_element_vis(slots[n], on);
+            }
+        }
+    }
+}
+
+/// \brief Number of nodes (containers and leaves).
+std::size_t Filter::SearchIndex::get_node_count()const{return elements.size();}
+
+/// \brief Number of leaves.
+std::size_t Filter::SearchIndex::get_leaf_count()const{return leaf_nodes.size();}
+
+/// \brief Memory of the folded texts and the posting lists.
+std::size_t Filter::SearchIndex::get_bytes()const
+{
+    auto postings = [](const Postings& p) {
+        return (p.keys.capacity() + p.starts.capacity() + p.ids.capacity()) * sizeof(std::uint32_t);
+    };
+    return text.capacity() + (strings.capacity() + paths.capacity()) * sizeof(Span) +
+           (name_ids.capacity() + comment_ids.capacity()) * sizeof(std::uint32_t) +
+           postings(string_grams) + postings(path_grams);
+}
+
+/// \brief Duration of build().
+double Filter::SearchIndex::get_build_ms()const{return build_ms;}
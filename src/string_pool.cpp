@@ -0,0 +1,54 @@
+#include <string_pool.hpp>
+#include <arena.hpp>
+
+/// \brief Pooled copy of \p s, stored on first use.
+const std::string& StringPool::intern(std::string_view s)
+{
+    Shard& shard = shards[std::hash<std::string_view>()(s) % shard_count];
+
+    std::lock_guard<std::mutex> lk(shard.mtx);
+    auto it = shard.index.find(s);
+    if (it != shard.index.end()) {
+        ++shard.hits;
+        return *it->second;
+    }
+
+    // The deque never moves its strings, the key views their characters.
+    const std::string& stored = shard.storage.emplace_back(s);
+    shard.index.emplace(std::string_view(stored), &stored);
+    shard.bytes += stored.size();
+    return stored;
+}
+
+/// \brief Totals over all shards.
+StringPoolStats StringPool::get_stats()
+{
+    StringPoolStats stats;
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lk(shard.mtx);
+        stats.strings += shard.storage.size();
+        stats.bytes += shard.bytes;
+        stats.hits += shard.hits;
+    }
+    return stats;
+}
+
+/// \brief Empty string, from the constants pool.
+PooledString::PooledString()
+{
+    static const std::string* empty = &string_pool::constants().intern({});
+    str = empty;
+}
+
+/// \brief Interns \p s in the pool of the current arena (see arena::Scope).
+PooledString::PooledString(std::string_view s)
+{
+    const auto& a = arena::current();
+    str = &(a != nullptr ? a->get_strings() : string_pool::constants()).intern(s);
+}
+
+StringPool& string_pool::constants()
+{
+    static StringPool pool;
+    return pool;
+}
@@ -0,0 +1,95 @@
+#include <subscriptions.hpp>
+#include <classes.hpp>
+
+/// \brief Adds \p el to the interest set of \p view.
+void SubscriptionRegistry::subscribe(const std::string& view,const VariantElement& el)
+{
+    auto& els = interests[view];
+    if (std::find(els.begin(), els.end(), el) != els.end()) return;
+    els.push_back(el);
+    dirty = true;
+}
+
+/// \brief Replaces the whole interest set of \p view; no-op if it did not change.
+void SubscriptionRegistry::set(const std::string& view,const std::vector<VariantElement>& els)
+{
+    if (els.empty()) { unsubscribe(view); return; }
+
+    auto it = interests.find(view);
+    if (it != interests.end() && it->second == els) return;
+    interests[view] = els;
+    dirty = true;
+}
+
+/// \brief Drops every subscription of \p view.
+void SubscriptionRegistry::unsubscribe(const std::string& view)
+{
+    if (interests.erase(view) > 0) dirty = true;
+}
+
+/// \brief Drops all subscriptions (e.g. when another DB is loaded).
+void SubscriptionRegistry::clear()
+{
+    if (interests.empty() && leaves.empty()) return;
+    interests.clear();
+    dirty = true;
+}
+
+/// \brief Sets the gap (bytes) below which neighbouring subscribed fields are read as one range.
+void SubscriptionRegistry::set_merge_gap(int gap)
+{
+    if (gap == merge_gap) return;
+    merge_gap = gap;
+    dirty = true;
+}
+
+/// \brief True if no view subscribed anything.
+bool SubscriptionRegistry::empty()const { return interests.empty(); }
+
+/// \brief True if \p view has at least one subscription.
+bool SubscriptionRegistry::has(const std::string& view)const { return interests.count(view) > 0; }
+
+/// \brief Increases every time the subscribed union changes.
+unsigned long SubscriptionRegistry::get_version()
+{
+    if (dirty || generation != class_utils::tree_generation()) _rebuild();
+    return version;
+}
+
+/// \brief Subscribed leaves (deduplicated, in offset order).
+const std::vector<BASE*>& SubscriptionRegistry::get_leaves()
+{
+    if (dirty || generation != class_utils::tree_generation()) _rebuild();
+    return leaves;
+}
+
+/// \brief Merged byte ranges covering the subscribed leaves; empty (not null) if nothing is subscribed.
+SharedRanges SubscriptionRegistry::get_ranges()
+{
+    if (dirty || generation != class_utils::tree_generation()) _rebuild();
+    return ranges;
+}
+
+/// \brief Recomputes the union of subscribed leaves and their merged byte ranges.
+/// \details Also runs when elements were materialized under a subscribed subtree.
+void SubscriptionRegistry::_rebuild()
+{
+    leaves.clear();
+    for (const auto& [view, els] : interests)
+        for (const auto& el : els) class_utils::collect_leaves(el, leaves);
+
+    std::sort(leaves.begin(), leaves.end(), [](const BASE* a, const BASE* b) {
+        return a->get_offset() != b->get_offset() ? a->get_offset() < b->get_offset() : a < b;
+    });
+    leaves.erase(std::unique(leaves.begin(), leaves.end()), leaves.end());
+
+    std::vector<ByteRange> fields;
+    fields.reserve(leaves.size());
+    for (const BASE* leaf : leaves)
+        fields.push_back(read_planner::field_range(*leaf));
+
+    ranges = std::make_shared<const std::vector<ByteRange>>(read_planner::merge(std::move(fields), merge_gap));
+    generation = class_utils::tree_generation();
+    ++version;
+    dirty = false;
+}
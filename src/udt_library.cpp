@@ -0,0 +1,212 @@
+#include <udt_library.hpp>
+#include <db_cache.hpp>
+#include <classes.hpp>
+#include <action.hpp>
+
+using namespace std::chrono;
+
+/* ---------------- Library ---------------- */
+
+/// \brief Shared definition of \p name with content \p hash, nullptr if not parsed yet.
+/// A hit is counted as a reuse.
+std::shared_ptr<UDT_RAW> UdtLibrary::find(const std::string& name,std::uint64_t hash)
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    auto it = entries.find({name, hash});
+    if (it == entries.end()) return nullptr;
+
+    ++stats.reused;
+    stats.saved_ms += it->second.parse_ms;
+    stats.saved_bytes += it->second.bytes;
+    return it->second.udt;
+}
+
+/// \brief Adds a freshly parsed definition and returns the instance to use: \p udt, or the
+/// one another thread inserted first for the same name and hash.
+std::shared_ptr<UDT_RAW> UdtLibrary::insert(const std::string& name,std::uint64_t hash,std::shared_ptr<UDT_RAW> udt,double parse_ms)
+{
+    std::size_t bytes = udt_library::tree_bytes(*udt);
+
+    std::lock_guard<std::mutex> lk(mtx);
+    auto [it, added] = entries.emplace(std::make_pair(name, hash), Entry{udt, parse_ms, bytes});
+    if (added) {
+        ++stats.unique;
+        stats.parse_ms += parse_ms;
+    }
+    return it->second.udt;
+}
+
+/// \brief Current counters.
+UdtLibraryStats UdtLibrary::get_stats()const
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    return stats;
+}
+
+/// \brief Drops every definition and resets the counters.
+void UdtLibrary::clear()
+{
+    std::lock_guard<std::mutex> lk(mtx);
+    entries.clear();
+    stats = UdtLibraryStats();
+}
+
+/* ---------------- Source splitting and parsing ---------------- */
+
+/// \brief True if \p line starts with \p key.
+static bool starts_with(std::string_view line,std::string_view key)
+{
+    return line.substr(0, key.size()) == key;
+}
+
+/// \brief Cuts \p text into its `TYPE` blocks and its `DATA_BLOCK` section.
+/// \details Each block runs from its `TYPE` line up to the next `TYPE` or `DATA_BLOCK` line.
+/// \return false if there is no DB section (the file is then parsed as a whole).
+bool udt_library::split(std::string_view text,SourceSplit& out)
+{
+    out.udts.clear();
+    out.db = {};
+    if (starts_with(text, "\xEF\xBB\xBF")) text.remove_prefix(3);
+
+    std::size_t block_start = std::string_view::npos;
+    std::string block_name;
+    auto close_block = [&](std::size_t end) {
+        if (block_start != std::string_view::npos)
+            out.udts.push_back({block_name, text.substr(block_start, end - block_start)});
+    };
+
+    for (std::size_t pos = 0; pos < text.size();) {
+        std::size_t eol = text.find('\n', pos);
+        std::size_t next = eol == std::string_view::npos ? text.size() : eol + 1;
+        std::string_view line = text.substr(pos, next - pos);
+
+        if (starts_with(line, "TYPE ")) {
+            close_block(pos);
+            block_start = pos;
+            line.remove_prefix(5);
+            while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) line.remove_suffix(1);
+            block_name = std::string(line);
+        }
+        else if (starts_with(line, "DATA_BLOCK")) {
+            close_block(pos);
+            out.db = text.substr(pos);
+            return true;
+        }
+        pos = next;
+    }
+    return false;
+}
+
+/// \brief Approximate heap size of a UDT definition tree (names and types are pooled, not counted).
+std::size_t udt_library::tree_bytes(const UDT_RAW& udt)
+{
+    std::size_t bytes = sizeof(UDT_RAW);
+    std::vector<VariantElement> stack(udt.get_childs().begin(), udt.get_childs().end());
+
+    while (!stack.empty()) {
+        VariantElement el = std::move(stack.back());
+        stack.pop_back();
+        std::visit([&](auto&& ptr) {
+            using T = std::decay_t<decltype(*ptr)>;
+            bytes += sizeof(T);
+            if constexpr (std::is_same_v<T, UDT_ARRAY>) {
+                if (ptr->get_prototype() != nullptr) stack.push_back(ptr->get_prototype());
+            }
+            else if constexpr (!std::is_base_of_v<BASE, T>) {
+                for (auto& ch : ptr->get_childs()) stack.push_back(ch);
+            }
+        }, el);
+    }
+    return bytes;
+}
+
+/// \brief Library key of \p block: the hash of its text mixed with the keys of the UDTs it
+/// references (quoted names already in \p keys, in order of first use).
+/// \details The parser copies nested UDTs into the outer definition, so two files with the
+/// same outer text but a different nested UDT of the same name must not share an entry.
+/// The keys of the nested UDTs already cover their own references.
+static std::uint64_t block_key(const udt_library::UdtBlock& block,const std::map<std::string,std::uint64_t>& keys)
+{
+    std::uint64_t key = db_cache::hash_bytes(reinterpret_cast<const unsigned char*>(block.text.data()), block.text.size());
+    std::vector<std::string_view> seen;
+
+    std::string_view text = block.text;
+    for (std::size_t open = text.find('"'); open != std::string_view::npos; ) {
+        std::size_t close = text.find('"', open + 1);
+        if (close == std::string_view::npos) break;
+
+        std::string_view quoted = text.substr(open, close - open + 1);
+        open = text.find('"', close + 1);
+        if (quoted == block.name || std::find(seen.begin(), seen.end(), quoted) != seen.end()) continue;
+
+        auto it = keys.find(std::string(quoted));
+        if (it == keys.end()) continue;
+        seen.push_back(quoted);
+
+        const std::uint64_t mix[2] = {key, it->second};
+        key = db_cache::hash_bytes(reinterpret_cast<const unsigned char*>(mix), sizeof(mix));
+    }
+    return key;
+}
+
+/// \brief Parses the DB of \p path, taking its UDTs from \p library when they are known.
+/// \param udts [out] UDT registry of the file (shared instances).
+/// \details Unknown UDT blocks are parsed alone (udt_block) with the definitions before them
+/// already registered, then added to \p library; the DB section is parsed last (db_section),
+/// its nodes allocated in a new ElementArena. All names are interned in \p strings.
+/// Safe to call from several threads, each call has its own ParserState.
+/// \throws std::runtime_error if the file cannot be read or parsed.
+std::shared_ptr<DB> udt_library::parse(const std::string& path,const std::string& name,UdtLibrary& library,UdtRawMap& udts,std::shared_ptr<StringPool> strings)
+{
+    MappedFile file(path);
+    if (!file.is_open()) throw std::runtime_error("cannot read file");
+    std::string_view text(reinterpret_cast<const char*>(file.data()), file.size());
+
+    ParserState state;
+    state.DB_name = name;
+    auto tree = std::make_shared<ElementArena>(strings);
+
+    SourceSplit parts;
+    if (!split(text, parts)) {
+        arena::Scope scope(tree);
+        pt::memory_input<> in(text.data(), text.size(), path);
+        if (!pt::parse<complete_datablock,action>(in, state))
+            throw std::runtime_error("DB does not match the grammar");
+    }
+    else {
+        std::map<std::string,std::uint64_t> keys;      // Library key of every UDT of the file.
+        auto defs = std::make_shared<ElementArena>(strings);     // UDTs added to the library.
+        for (const auto& block : parts.udts) {
+            auto hash = block_key(block, keys);
+            keys[block.name] = hash;
+            auto udt = library.find(block.name, hash);
+
+            if (udt == nullptr) {
+                auto t0 = steady_clock::now();
+                arena::Scope scope(defs);
+                pt::memory_input<> in(block.text.data(), block.text.size(), path);
+                if (!pt::parse<udt_block,action>(in, state))
+                    throw std::runtime_error("UDT " + block.name + " does not match the grammar");
+
+                auto it = state.udt_database.find(block.name);
+                if (it == state.udt_database.end())
+                    throw std::runtime_error("UDT " + block.name + " not registered");
+                udt = library.insert(block.name, hash, it->second,
+                                     duration<double,std::milli>(steady_clock::now() - t0).count());
+            }
+            state.udt_database[block.name] = udt;
+        }
+
+        // The shared definitions stay in their own arena, the DB tree goes in its own.
+        arena::Scope scope(tree);
+        pt::memory_input<> in(parts.db.data(), parts.db.size(), path);
+        if (!pt::parse<db_section,action>(in, state))
+            throw std::runtime_error("DB section does not match the grammar");
+    }
+
+    if (state.db == nullptr) throw std::runtime_error("DB not created");
+    state.db->set_arena(tree);
+    state.db->_set_offset();
+    udts = std::move(state.udt_database);
+    return state.db;
+}